@@ -8,6 +8,7 @@
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include "lib/kernel/list.h"
+#include "intrinsic.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -18,12 +19,30 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
-#define F (1 << (14))
-#define ADD_INT(x, n) ((x) + (n) * (F))
+/* 8254 input frequency and the counter value for one timer tick. */
+#define PIT_FREQ 1193180
+#define PIT_TICK_COUNT ((PIT_FREQ + TIMER_FREQ / 2) / TIMER_FREQ)
 
 /* OS가 부팅된 이후 타이머의 틱수. */
 static int64_t ticks;
 
+/* -tickless: while the idle thread halts, program the PIT one-shot
+   for the next sleep deadline instead of taking every tick.
+   Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* State of an armed one-shot.  Only valid while oneshot_armed. */
+static bool oneshot_armed;
+static int64_t oneshot_ticks;   /* Ticks the one-shot stands for. */
+static uint16_t oneshot_count;  /* Counter value it was loaded with. */
+static uint16_t oneshot_first;  /* Counts left in the tick it started in. */
+
+/* # of timer interrupts that tickless idle did not take. */
+static int64_t skipped_ticks;
+
+/* Worst-case cost of one timer_interrupt() call, in TSC cycles. */
+static uint64_t max_intr_cycles;
+
 /* 타이머 틱당 루프의 수
    timer_calibrate().에 의해 초기화 된다. */
 static unsigned loops_per_tick;
@@ -32,6 +51,9 @@ static intr_handler_func timer_interrupt;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
+static void pit_set_periodic (void);
+static uint16_t pit_read_count (void);
+static void timer_catch_up (int64_t missed);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT)     pit = 프로그래밍된 카운트에 도달할 때 출력 신호를 생성하는 카운터
    interrupt PIT_FREQ times per second, and registers the
@@ -39,14 +61,120 @@ static void real_time_sleep (int64_t num, int32_t denom);
    초당 PIT_FREQ를 인터럽트하고 해당 인터럽트를 등록시킨다.*/
 void
 timer_init (void) {
+	pit_set_periodic ();
+	intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+}
+
+/* Programs counter 0 to interrupt every timer tick. */
+static void
+pit_set_periodic (void) {
 	/* 8254 입력 주파수를 TIMER_FREQ로 나눈 값을 가장 가까운 값으로 반올림합니다. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+	uint16_t count = PIT_TICK_COUNT;
 
 	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
 	outb (0x40, count & 0xff);
 	outb (0x40, count >> 8);
+}
 
-	intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+/* Returns the current value of counter 0. */
+static uint16_t
+pit_read_count (void) {
+	uint8_t lo, hi;
+
+	outb (0x43, 0x00);    /* CW: latch counter 0. */
+	lo = inb (0x40);
+	hi = inb (0x40);
+	return lo | (hi << 8);
+}
+
+/* Called by the idle thread, with interrupts off, right before it
+   halts.  In tickless mode, stops the periodic tick and programs
+   the PIT to interrupt once, at the earliest tick on which a
+   sleeping thread has to be woken.  The 16-bit counter limits
+   this to a few ticks at a time. */
+void
+timer_idle_enter (void) {
+	uint16_t first;
+	int64_t max_ticks, next, delta;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (!timer_tickless || oneshot_armed)
+		return;
+
+	/* Keep the one-shot aligned with the tick grid: its first
+	   period is whatever is left of the current tick. */
+	first = pit_read_count ();
+	if (first == 0 || first > PIT_TICK_COUNT)
+		return;
+	max_ticks = 1 + (0xffff - first) / PIT_TICK_COUNT;
+
+	next = thread_next_wakeup (max_ticks);
+	delta = next - ticks;
+	if (delta <= 1)
+		return;
+	if (delta > max_ticks)
+		delta = max_ticks;
+
+	oneshot_first = first;
+	oneshot_count = first + (delta - 1) * PIT_TICK_COUNT;
+	oneshot_ticks = delta;
+	oneshot_armed = true;
+
+	outb (0x43, 0x30);    /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb (0x40, oneshot_count & 0xff);
+	outb (0x40, oneshot_count >> 8);
+}
+
+/* Called by the idle thread after it wakes up from halting.  If
+   something other than the timer woke it up, the one-shot is
+   still armed: account for the ticks that have passed since it
+   was armed and go back to the periodic tick. */
+void
+timer_idle_exit (void) {
+	enum intr_level old_level;
+
+	if (!timer_tickless)
+		return;
+
+	old_level = intr_disable ();
+	if (oneshot_armed) {
+		uint16_t now = pit_read_count ();
+		uint16_t passed = oneshot_count - now;
+		int64_t elapsed = 0;
+
+		if (now == 0 || now > oneshot_count) {
+			/* The one-shot already expired and its interrupt is
+			   pending; that interrupt will count the last tick. */
+			elapsed = oneshot_ticks - 1;
+		} else if (passed >= oneshot_first)
+			elapsed = 1 + (passed - oneshot_first) / PIT_TICK_COUNT;
+
+		oneshot_armed = false;
+		pit_set_periodic ();
+		if (elapsed > 0) {
+			timer_catch_up (elapsed);
+			thread_wakeup (ticks);
+		}
+	}
+	intr_set_level (old_level);
+}
+
+/* Accounts for MISSED ticks that passed without a timer
+   interrupt while the idle thread was halted. */
+static void
+timer_catch_up (int64_t missed) {
+	int64_t old_ticks = ticks;
+
+	ticks += missed;
+	skipped_ticks += missed;
+	thread_idle_catch_up (missed);
+
+	/* Do not lose the once-per-second MLFQS update. */
+	if (thread_mlfqs && ticks / TIMER_FREQ != old_ticks / TIMER_FREQ) {
+		update_load_avg ();
+		calc_all_recent_cpu ();
+		calculate_all_priority ();
+	}
 }
 
 /* Calibrates loops_per_tick, used to implement brief delays. */
@@ -136,39 +264,49 @@ timer_nsleep (int64_t ns) {
 void
 timer_print_stats (void) {
 	printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
+	printf ("Timer: %"PRIu64" cycles in the slowest timer interrupt\n",
+			max_intr_cycles);
+	if (timer_tickless)
+		printf ("Timer: %"PRId64" ticks skipped while idle\n", skipped_ticks);
 }
 
 /* Timer interrupt handler. */
 // 인터럽트 핸들러
 static void
 timer_interrupt (struct intr_frame *args UNUSED) {
+	uint64_t start = rdtsc ();
+	uint64_t cycles;
+
+	/* A one-shot armed by timer_idle_enter() stands for several
+	   ticks; catch up on all but the last one first. */
+	if (oneshot_armed) {
+		oneshot_armed = false;
+		pit_set_periodic ();
+		timer_catch_up (oneshot_ticks - 1);
+	}
+
 	ticks++;
 	thread_tick ();
 
 	thread_wakeup(ticks);
-	enum intr_level  old_level;
 	if (thread_mlfqs == true){
-		struct thread *cur;
-		cur = thread_current();
-		if (cur->status == THREAD_RUNNING)
-			cur->recent_cpu = ADD_INT (cur->recent_cpu, 1);
+		increase_recent_cpu();
 
-		if(timer_ticks() % TIMER_FREQ == 0){
+		/* 매 초마다 load_avg와 모든 쓰레드의 recent_cpu를 갱신한다. */
+		if(ticks % TIMER_FREQ == 0){
 			update_load_avg();
-			// if (cur->status == THREAD_RUNNING)
-				// calculating_recent_cpu(thread_current);
-			
-			//이걸 끄면 load 60가 되고 키면 recent-1이 됨
-			// calc_all_recent_cpu();
-			// if (!list_empty(&ready_list))
-			// 	list_sort(&ready_list, priority_scheduling, NULL);
+			calc_all_recent_cpu();
+		}
+		/* 4틱마다 recent_cpu가 바뀐 쓰레드들의 priority만 다시 계산한다.
+		   run queue가 우선순위별로 나뉘어 있으므로 정렬은 필요 없다. */
+		if(ticks % 4 == 0){
+			calculate_all_priority();
 		}
-		// if(timer_ticks() % 4 == 0){
-		// 	calculate_all_priority();
-		// }
-
 	}
 
+	cycles = rdtsc () - start;
+	if (cycles > max_intr_cycles)
+		max_intr_cycles = cycles;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -1,4 +1,5 @@
 #ifndef INSTRINSIC_H
+#define INSTRINSIC_H
 #include "threads/mmu.h"
 
 /* Store the physical address of the page directory into CR3
@@ -119,6 +120,57 @@ static __inline uint64_t rcr2(void) {
 	return val;
 }
 
+__attribute__((always_inline))
+static __inline uint64_t rcr0(void) {
+	uint64_t val;
+	__asm __volatile("movq %%cr0,%0" : "=r" (val));
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline void lcr0(uint64_t val) {
+	__asm __volatile("movq %0, %%cr0" : : "r" (val));
+}
+
+__attribute__((always_inline))
+static __inline uint64_t rcr4(void) {
+	uint64_t val;
+	__asm __volatile("movq %%cr4,%0" : "=r" (val));
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline void lcr4(uint64_t val) {
+	__asm __volatile("movq %0, %%cr4" : : "r" (val));
+}
+
+/* Clears CR0.TS so that FPU instructions no longer trap. */
+__attribute__((always_inline))
+static __inline void clts(void) {
+	__asm __volatile("clts");
+}
+
+/* Saves the x87/MMX/SSE state into the 16-byte aligned,
+   512-byte area at AREA.  See [IA32-v2a] "FXSAVE". */
+__attribute__((always_inline))
+static __inline void fxsave(void *area) {
+	__asm __volatile("fxsave64 (%0)" : : "r" (area) : "memory");
+}
+
+/* Loads the x87/MMX/SSE state from AREA. */
+__attribute__((always_inline))
+static __inline void fxrstor(const void *area) {
+	__asm __volatile("fxrstor64 (%0)" : : "r" (area) : "memory");
+}
+
+/* Reads the time-stamp counter.  See [IA32-v2b] "RDTSC". */
+__attribute__((always_inline))
+static __inline uint64_t rdtsc(void) {
+	uint32_t lo, hi;
+	__asm __volatile("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
 __attribute__((always_inline))
 static __inline void write_msr(uint32_t ecx, uint64_t val) {
 	uint32_t edx, eax;
@@ -0,0 +1,19 @@
+#ifndef __LIB_INTR_STATS_H
+#define __LIB_INTR_STATS_H
+
+#include <stdint.h>
+
+/* Latency statistics for one interrupt vector, in rdtsc()
+   cycles, as kept by the kernel and returned by intr_stats().
+   Slot INTR_STAT_SYSCALL covers system calls, which enter
+   through SYSCALL instead of an interrupt vector. */
+#define INTR_STAT_SYSCALL 256
+
+struct intr_stats {
+	uint64_t count;             /* # of times taken. */
+	uint64_t cycles;            /* Total cycles spent handling it. */
+	uint64_t max_cycles;        /* Longest single run. */
+	uint64_t max_off_cycles;    /* Longest run with interrupts off. */
+};
+
+#endif /* lib/intr-stats.h */
@@ -0,0 +1,61 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Max-heap.
+ *
+ * This is an intrusive pairing heap: like struct list, it does
+ * not allocate memory.  Each structure that can be in a heap
+ * embeds a struct heap_elem, and heap_entry() converts a
+ * struct heap_elem back into the structure that contains it.
+ *
+ * heap_push() is O(1), heap_max() is O(1), and heap_pop_max()
+ * and heap_remove() are amortized O(log n).  To change the key
+ * of an element, remove it, change the key and push it again.
+ *
+ * An element can be in at most one heap at a time, and the
+ * ordering of elements must not change while they are in the
+ * heap. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *child;    /* First child. */
+	struct heap_elem *next;     /* Next sibling. */
+	struct heap_elem *prev;     /* Previous sibling, or parent if first. */
+};
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;     /* Maximum element, or null. */
+	size_t size;                /* Number of elements. */
+	heap_less_func *less;       /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child    \
+		- offsetof (STRUCT, MEMBER.child)))
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+void heap_push (struct heap *, struct heap_elem *);
+void heap_remove (struct heap *, struct heap_elem *);
+struct heap_elem *heap_pop_max (struct heap *);
+struct heap_elem *heap_max (const struct heap *);
+size_t heap_size (const struct heap *);
+bool heap_empty (const struct heap *);
+
+#endif /* lib/kernel/heap.h */
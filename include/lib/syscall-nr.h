@@ -36,6 +36,19 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Threads sharing one address space. */
+	SYS_UTHREAD_CREATE,         /* Start a thread in this process. */
+	SYS_UTHREAD_JOIN,           /* Wait for such a thread to exit. */
+	SYS_UTHREAD_EXIT,           /* End the calling thread only. */
+
+	/* User-space synchronization. */
+	SYS_FUTEX_WAIT,             /* Sleep if a futex holds a value. */
+	SYS_FUTEX_WAKE,             /* Wake threads sleeping on a futex. */
+
+	/* Diagnostics. */
+	SYS_SCHED_TRACE,            /* Dump scheduler trace to the console. */
+	SYS_INTR_STATS,             /* Get interrupt latency statistics. */
 };
 
 #endif /* lib/syscall-nr.h */
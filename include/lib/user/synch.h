@@ -0,0 +1,36 @@
+#ifndef __LIB_USER_SYNCH_H
+#define __LIB_USER_SYNCH_H
+
+#include <stdbool.h>
+
+/* Mutexes and condition variables for user programs, built on
+   futex_wait() and futex_wake().  Neither makes a system call
+   unless some thread actually has to sleep or be woken. */
+
+/* Mutex.  STATE is 0 if unlocked, 1 if locked, and 2 if locked
+   with threads possibly sleeping on it. */
+struct mutex {
+	int state;
+};
+
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+/* Condition variable.  SEQ changes on every signal, so that a
+   waiter can tell a wakeup it has missed from one still to come. */
+struct condvar {
+	int seq;
+};
+
+#define CONDVAR_INITIALIZER { 0 }
+
+void condvar_init (struct condvar *);
+void condvar_wait (struct condvar *, struct mutex *);
+void condvar_signal (struct condvar *);
+void condvar_broadcast (struct condvar *);
+
+#endif /* lib/user/synch.h */
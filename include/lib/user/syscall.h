@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <intr-stats.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -37,6 +39,15 @@ unsigned tell (int fd);
 void close (int fd);
 
 int dup2(int oldfd, int newfd);
+typedef void uthread_func (void *aux);
+pid_t uthread_create (uthread_func *, void *aux);
+int uthread_join (pid_t);
+void uthread_exit (int status) NO_RETURN;
+
+int futex_wait (int *addr, int expected);
+int futex_wake (int *addr, int n);
+void sched_trace (void);
+bool intr_stats (int vec, struct intr_stats *);
 
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
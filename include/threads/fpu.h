@@ -0,0 +1,22 @@
+#ifndef THREADS_FPU_H
+#define THREADS_FPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* Saved x87, MMX and SSE registers of a thread, in the layout
+   written by FXSAVE.  The area must be 16-byte aligned, which
+   malloc() does not promise, so it is found at fpu_area(). */
+struct fpu_state {
+	uint8_t buf[512 + 15];
+};
+
+void fpu_init (void);
+void fpu_switch (struct thread *next);
+void fpu_reset (void);
+bool fpu_fork (struct thread *child, struct thread *parent);
+void fpu_print_stats (void);
+
+#endif /* threads/fpu.h */
@@ -1,6 +1,7 @@
 #ifndef THREADS_INTERRUPT_H
 #define THREADS_INTERRUPT_H
 
+#include <intr-stats.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -65,6 +66,18 @@ struct intr_frame {
 
 typedef void intr_handler_func (struct intr_frame *);
 
+/* Statistics slots: one per interrupt vector, then
+   INTR_STAT_SYSCALL. */
+#define INTR_STAT_CNT (INTR_STAT_SYSCALL + 1)
+
+/* Bookkeeping for one handler run; see intr_stats_enter(). */
+struct intr_stats_scope {
+	int slot;                   /* Slot being measured. */
+	uint64_t start;             /* rdtsc() at entry. */
+	int outer_slot;             /* Slot of the run we interrupted. */
+	uint64_t outer_off;         /* Its intr_off_since. */
+};
+
 void intr_init (void);
 void intr_register_ext (uint8_t vec, intr_handler_func *, const char *name);
 void intr_register_int (uint8_t vec, int dpl, enum intr_level,
@@ -75,4 +88,10 @@ void intr_yield_on_return (void);
 void intr_dump_frame (const struct intr_frame *);
 const char *intr_name (uint8_t vec);
 
+void intr_stats_enter (struct intr_stats_scope *, int slot);
+void intr_stats_exit (struct intr_stats_scope *);
+void intr_stats_abandon (void);
+bool intr_get_stats (int slot, struct intr_stats *);
+void intr_print_stats (void);
+
 #endif /* threads/interrupt.h */
@@ -1,13 +1,36 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
+#include <heap.h>
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+
+/* A ticket spinlock.  Each locker takes the next ticket and spins
+   until OWNER reaches it, so waiters are served in FIFO order.
+   A spinlock must never be held across a sleep, and one that is
+   also taken by an interrupt handler must be locked with
+   spin_lock_irqsave(). */
+struct spinlock {
+	unsigned next;              /* Next ticket to hand out. */
+	unsigned owner;             /* Ticket currently being served. */
+	struct thread *holder;      /* Thread holding the lock (for debugging). */
+	uint64_t acquired_at;       /* rdtsc() when the lock was taken. */
+};
+
+void spin_lock_init (struct spinlock *);
+void spin_lock (struct spinlock *);
+void spin_unlock (struct spinlock *);
+enum intr_level spin_lock_irqsave (struct spinlock *);
+void spin_unlock_irqrestore (struct spinlock *, enum intr_level);
+void spin_lock_print_stats (void);
 
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct heap waiters;        /* Waiting threads, highest priority on top. */
+	struct spinlock lock;       /* Protects VALUE and WAITERS. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -16,11 +39,26 @@ bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
+/* Lock states.  A lock is taken with a single compare-and-swap
+   from LOCK_FREE to LOCK_HELD while nobody waits for it; a waiter
+   marks it LOCK_CONTENDED so that the release wakes it up. */
+#define LOCK_FREE 0
+#define LOCK_HELD 1
+#define LOCK_CONTENDED 2
+
+/* Maximum length of the chain of locks a priority donation is
+   passed along. */
+#ifndef DONATION_DEPTH_MAX
+#define DONATION_DEPTH_MAX 8
+#endif
+
 /* Lock. */
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
-	struct semaphore semaphore; /* Binary semaphore controlling access. */
-	struct list_elem lock_elem;
+	int state;                  /* LOCK_FREE, LOCK_HELD or LOCK_CONTENDED. */
+	struct heap waiters;        /* Waiting threads, highest priority on top. */
+	struct heap_elem held_elem; /* Element in DONEE's held_locks. */
+	struct thread *donee;       /* Holder this lock donates to, or NULL. */
 	int lock_priority; /* lock중 가장 큰 우선순위 */
 };
 
@@ -29,10 +67,47 @@ void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+heap_less_func lock_priority_less;
+void donation_update (struct thread *);
+void sema_requeue (struct thread *);
+void lock_requeue (struct thread *);
+
+/* Readers-writer lock.  Any number of readers, up to
+   RWLOCK_READERS, may hold it at once; a writer holds it alone.
+   Waiting writers are preferred over new readers, and a waiter
+   donates its priority to every thread holding the lock. */
+#define RWLOCK_READERS 8
+
+/* One thread's hold on an rwlock.  While somebody waits for the
+   rwlock, the hold is in its holder's held_rwlocks heap and
+   donates the top waiter's priority, as a contended lock does. */
+struct rwlock_hold {
+	struct thread *holder;      /* Holding thread, or NULL if unused. */
+	struct heap_elem held_elem; /* Element in HOLDER's held_rwlocks. */
+	int priority;               /* Priority donated to HOLDER. */
+	bool donating;              /* In HOLDER's held_rwlocks? */
+};
+
+struct rwlock {
+	struct spinlock lock;       /* Protects the fields below. */
+	struct rwlock_hold writer;  /* Writer holding the lock, if any. */
+	struct rwlock_hold readers[RWLOCK_READERS]; /* Readers holding the lock. */
+	int reader_cnt;             /* # of READERS in use. */
+	int donation;               /* Priority the holds donate, if >= PRI_MIN. */
+	struct list read_waiters;   /* Threads waiting to read. */
+	struct list write_waiters;  /* Threads waiting to write. */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+heap_less_func rwlock_hold_less;
 
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct heap waiters;        /* Waiting semaphore_elems, by priority. */
 };
 
 void cond_init (struct condition *);
@@ -2,6 +2,8 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
@@ -32,6 +34,12 @@ typedef int tid_t;
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63     /* Highest priority. */
 
+/* Deadline (EDF) scheduling class.  Ready EDF threads run before
+   any other thread, earliest deadline first.  The total bandwidth
+   runtime/period of admitted EDF threads is kept at or below
+   EDF_UTIL_MAX per mille so that the rest still get the CPU. */
+#define EDF_UTIL_MAX 900
+
 /* A kernel thread or user process.
  *
  * Each thread structure is stored in its own 4 kB page.  The
@@ -91,32 +99,72 @@ typedef int tid_t;
  * blocked state is on a semaphore wait list. */
 struct thread
 {
-    /* Owned by thread.c. */
-    tid_t tid;                 /* Thread identifier. */
+    /* Hot: touched on every schedule() and next_thread_to_run().
+       These share the first cache line of the page; thread.c
+       checks that at build time. */
     enum thread_status status; /* Thread state. */
-    char name[16];             /* Name (for debugging purposes). */
     int priority;              /* Priority. */
-    int original_priority;     /* 원래의 우선도(priority)*/
-    int64_t sleep_ticks;       /* 자고 있는 시간*/
-    int has_lock;
+    int ready_priority;        /* Run queue this thread is linked into. */
+    tid_t tid;                 /* Thread identifier. */
+    unsigned time_slice;       /* # of timer ticks per turn on the CPU. */
     /* Shared between thread.c and synch.c. */
     struct list_elem elem; /* List element. */
-    struct list_elem donor_elem;
+#ifdef USERPROG
+    /* Owned by userprog/process.c. */
+    uint64_t *pml4; /* Page map level 4 */
+#endif
 
-    struct list donors;        /* 해당 쓰레드에 기부한 목록*/
-    struct lock *wait_on_lock; /* 이 락이 없어서 못 가고 있을 때*/
+    /* Owned by thread.c. */
+    struct intr_frame tf; /* Information for switching */
 
+    /* Priority donation and MLFQS. */
+    int original_priority;     /* 원래의 우선도(priority)*/
+    int has_lock;
     int nice_value;
     int recent_cpu;
+    int64_t sleep_ticks;       /* 자고 있는 시간*/
+    struct heap_elem waiter_elem; /* Element in wait_on_lock's or
+                                     wait_on_sema's waiters. */
+    uint64_t waiter_seq;          /* Arrival order among waiters. */
+    struct heap held_locks;    /* 기부를 받고 있는 보유 락들 (max-heap) */
+    struct heap held_rwlocks;  /* Donating rwlock holds (max-heap). */
+    struct lock *wait_on_lock; /* 이 락이 없어서 못 가고 있을 때*/
+    struct semaphore *wait_on_sema; /* Semaphore we sleep on, if any. */
+    struct rwlock *wait_on_rwlock; /* Rwlock we wait for, if any. */
     struct list_elem all_elem;
-
-#ifdef USERPROG
-    /* Owned by userprog/process.c. */
-    uint64_t *pml4; /* Page map level 4 */
-    struct list fd_table;
-    unsigned last_created_fd;
-
-#endif
+    bool mlfqs_dirty;            /* On the MLFQS recalculation list? */
+    struct list_elem mlfqs_elem; /* Element of that list. */
+
+    /* Deadline scheduling; dl_period is 0 outside the EDF class.
+       All times are in timer ticks. */
+    int64_t dl_runtime;        /* Budget per period. */
+    int64_t dl_period;         /* Period, which is also the relative deadline. */
+    int64_t dl_release;        /* Start of the current period. */
+    int64_t dl_deadline;       /* Absolute deadline; the EDF key. */
+    int64_t dl_budget;         /* Budget left in this period. */
+    int dl_util;               /* runtime/period, per mille. */
+    struct heap_elem dl_elem;  /* Element of edf_queue. */
+    bool dl_throttled;         /* Out of budget until dl_release? */
+    struct list_elem dl_throttle_elem; /* Element of the throttled list. */
+
+    /* Cold. */
+    char name[16];             /* Name (for debugging purposes). */
+    struct process *proc;      /* Process bookkeeping, see below. */
+    struct fpu_state *fpu;     /* FPU save area, allocated on first use. */
+
+    /* CPU accounting, in TSC cycles.  Updated by schedule(). */
+    uint64_t acct_stamp;       /* When the thread last started running
+                                  or became ready. */
+    uint64_t run_cycles;       /* Time spent running. */
+    uint64_t wait_cycles;      /* Time spent ready but not running. */
+    unsigned nvcsw;            /* # of switches away by blocking. */
+    unsigned nivcsw;           /* # of switches away while runnable. */
+
+    /* Interrupt latency statistics; see intr_stats_enter(). */
+    int intr_slot;             /* Slot of the innermost run being
+                                  measured, or -1. */
+    uint64_t intr_off_since;   /* rdtsc() when interrupts were turned
+                                  off in it, or 0. */
 #ifdef VM
     /* Table for whole virtual memory owned by thread. */
     struct supplemental_page_table spt;
@@ -124,13 +172,29 @@ struct thread
     void *stack_bottom;
 #endif
 
-    /* Owned by thread.c. */
-    struct intr_frame tf; /* Information for switching */
+    /* Owned by thread.c.  Must stay last: a kernel stack overflow
+       clobbers it first. */
     unsigned magic;       /* Detects stack overflow. */
+};
+
+/* Key of a struct process in the tid table; see
+   process_register(). */
+struct tid_key
+{
+    tid_t tid;
+    struct hash_elem elem;
+};
 
-    // 구현
+/* Parent/child and file bookkeeping of a thread.  Only fork, wait,
+   exit and the file system calls touch it, so it is allocated
+   apart from the thread's page instead of sharing cache lines
+   with the scheduling state. */
+struct process
+{
+    struct thread *thread;     /* Thread this bookkeeping belongs to. */
     struct list child_list;
     struct list_elem child_list_elem;
+    struct tid_key key;        /* Element of the tid table until reaped. */
 
     struct thread *parent;
 
@@ -141,12 +205,33 @@ struct thread
     int fd_idx;
 
     struct file *running;
+    struct list fd_table;
+    unsigned last_created_fd;
     /* 자식 프로세스의 fork가 완료될 때까지 기다리도록 하기 위한 세마포어 */
     struct semaphore process_sema;
     struct semaphore wait_sema;
     struct semaphore exit_sema;
+
+    /* Threads made by uthread_create() share the address space
+       (pml4 and SPT) and the file descriptors of their process's
+       main thread, its leader.  The fields marked (leader) are
+       used only in the leader's struct process. */
+    struct process *leader;    /* Leader; this process for a main thread. */
+    struct lock lock;          /* (leader) Guards fd_table and the fields below. */
+    uint32_t stack_slots;      /* (leader) User stack slots in use, one bit each. */
+    int uthread_cnt;           /* (leader) # of live threads besides the leader. */
+    struct semaphore uthread_sema; /* (leader) Upped as each of those exits. */
+    bool dying;                /* (leader) exit() was called; threads die before user mode. */
+    int stack_slot;            /* Slot of this thread's user stack, or -1. */
+    struct uthread_args *spawning; /* Thread being made by process_uthread_create(). */
 };
 
+#ifdef VM
+/* Returns the supplemental page table of the address space that
+   thread T runs in. */
+#define thread_spt(T) (&(T)->proc->leader->thread->spt)
+#endif
+
 struct file_descriptor
 {
     unsigned fd;
@@ -159,11 +244,29 @@ struct file_descriptor
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* Why schedule() switched away from a thread. */
+enum sched_reason
+{
+    SCHED_BLOCK, /* Blocked or went to sleep. */
+    SCHED_YIELD, /* Yielded or was preempted, still runnable. */
+    SCHED_EXIT   /* Exited. */
+};
+
+/* Base time slice, in timer ticks.
+   Controlled by kernel command-line option "-ts=TICKS". */
+extern unsigned thread_time_slice;
+
+/* If true, thread_print_stats() also dumps the scheduler trace.
+   Controlled by kernel command-line option "-sched-trace". */
+extern bool thread_trace;
+
 void thread_init(void);
 void thread_start(void);
 
 void thread_tick(void);
+void thread_idle_catch_up(int64_t ticks);
 void thread_print_stats(void);
+void thread_print_trace(void);
 
 typedef void thread_func(void *aux);
 tid_t thread_create(const char *name, int priority, thread_func *, void *);
@@ -181,6 +284,9 @@ void thread_yield(void);
 int thread_get_priority(void);
 void thread_set_priority(int);
 
+bool thread_set_deadline(int64_t runtime, int64_t period);
+bool thread_wait_period(void);
+
 int thread_get_nice(void);
 void thread_set_nice(int);
 int thread_get_recent_cpu(void);
@@ -191,20 +297,21 @@ void do_iret(struct intr_frame *tf);
 // 구현목록
 void thread_sleep(int64_t ticks);
 void thread_wakeup(int64_t ticks);
+int64_t thread_next_wakeup(int64_t limit);
 
 void update_load_avg();
-void apply_to_all();
 int calculating_recent_cpu(struct thread *t);
+void increase_recent_cpu(void);
 struct list all_list;
-struct list ready_list;
 
 void calc_all_recent_cpu();
 bool priority_scheduling(const struct list_elem *a_, const struct list_elem *b_,
                          void *aux UNUSED);
 
-void update_priority();
+int calculate_advanced_priority(struct thread *t);
 void calculate_all_priority();
 void try_thread_yield();
+void thread_requeue(struct thread *t);
 
 #endif /* threads/thread.h */
 
@@ -3,12 +3,25 @@
 
 #include "threads/thread.h"
 
+/* Threads sharing a process's address space.  Each gets a user
+   stack of UTHREAD_STACK_PAGES pages in one of UTHREAD_MAX slots
+   below the main thread's stack. */
+#define UTHREAD_MAX 32
+#define UTHREAD_STACK_PAGES 16
+
+void process_table_init (void);
+void process_register (struct thread *child);
 tid_t process_create_initd (const char *file_name);
 tid_t process_fork (const char *name, struct intr_frame *if_);
 int process_exec (void *f_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (struct thread *next);
+tid_t process_uthread_create (uintptr_t entry, uint64_t arg0, uint64_t arg1);
+int process_uthread_join (tid_t);
+void process_uthread_exit (int status) NO_RETURN;
+void process_exit_group (int status) NO_RETURN;
+bool process_dying (void);
 bool lazy_load_segment(struct page *page, void *aux);
 
 
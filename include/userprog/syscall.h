@@ -6,6 +6,8 @@ void syscall_init (void);
 void close(int fd);
 struct lock filesys_lock;
 struct file_descriptor *find_file_descriptor(int fd);
+struct process;
+void futex_kill(struct process *leader);
 // tid_t fork (const char *thread_name, struct intr_frame *f)
 // 구현
 #endif /* userprog/syscall.h */
@@ -11,18 +11,11 @@ struct anon_page
     /* Initiate the contets of the page */
     enum vm_type type;
     void *va;
-    int slot_idx;
-};
-
-struct slot
-{
-    struct hash_elem swap_elem;
-    int used; // 사용중 1, 사용가능 0
-    int index;
-    struct page *page;
+    int slot_idx;   /* Swap slot holding the page, or -1. */
 };
 
 void vm_anon_init(void);
 bool anon_initializer(struct page *page, enum vm_type type, void *kva);
+void anon_swap_read(const struct page *page, void *kva);
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef VM_POLICY_H
+#define VM_POLICY_H
+#include <stdbool.h>
+#include <stddef.h>
+
+struct frame;
+
+/* A page replacement policy.
+ * Every function is called with vm_lock held.  A frame is handed to
+ * INSERT when it starts holding a page and to REMOVE when it stops,
+ * because the page is gone or the frame was picked for eviction. */
+struct frame_policy
+{
+    const char *name;
+    void (*init)(struct frame *frames, size_t frame_cnt);
+    void (*insert)(struct frame *);
+    void (*remove)(struct frame *);
+    /* Returns a frame that frame_evictable() accepts, or NULL if
+       there is none.  The caller may still pass it over, so the
+       next call must move on to another frame. */
+    struct frame *(*victim)(void);
+};
+
+bool frame_evictable(struct frame *);
+bool frame_accessed(struct frame *, bool clear);
+bool frame_dirty(const struct frame *);
+
+const struct frame_policy *frame_policy_find(const char *name);
+extern const struct frame_policy *frame_policy;
+
+#endif /* VM_POLICY_H */
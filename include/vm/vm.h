@@ -50,6 +50,9 @@ struct page
 
     /* Your implementation */
     struct hash_elem h_elem;
+    struct list_elem share_elem; /* Element of frame->sharers. */
+    struct thread *sharer;       /* While in frame->sharers, leader of the process mapping it. */
+    uint64_t policy_seq;         /* Replacement policy state kept while swapped out. */
 
     bool writable;
 
@@ -66,12 +69,21 @@ struct page
     };
 };
 
-/* The representation of "frame" */
+/* The representation of "frame"
+   One entry per user pool page, indexed by palloc_user_page_idx().
+   An entry whose KVA is null is not allocated. */
 struct frame
 {
     void *kva;
     struct page *page;
-    struct list_elem f_elem;
+    struct thread *owner; /* Leader of the process whose page table maps PAGE. */
+    bool pinned;          /* Being filled or evicted; not a victim. */
+    struct list_elem policy_elem; /* For the replacement policy's queues. */
+    int policy_queue;             /* Which of them. */
+    /* Pages besides PAGE that map this frame read-only since a
+       fork, until they write to it (copy-on-write).  Evicting a
+       shared frame swaps every one of them out. */
+    struct list sharers;
 };
 
 /* The function table for page operations.
@@ -108,6 +120,8 @@ struct lock vm_lock;
 struct supplemental_page_table
 {
     struct hash hash_table;
+    struct rwlock lock; /* 조회는 여러 쓰레드가 동시에, 삽입/삭제는 단독으로 */
+    struct lock claim_lock; /* 같은 주소 공간의 쓰레드들이 한 페이지를 두 번 claim하지 않도록 */
 };
 
 #include "threads/thread.h"
@@ -121,6 +135,8 @@ bool spt_insert_page(struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page);
 
 void vm_init(void);
+extern bool vm_kswapd;
+bool vm_set_policy(const char *name);
 bool vm_try_handle_fault(struct intr_frame *f, void *addr, bool user,
                          bool write, bool not_present);
 
@@ -130,6 +146,8 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage,
                                     bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page(struct page *page);
 bool vm_claim_page(void *va);
+void vm_frame_release(struct page *page);
+void vm_print_stats(void);
 enum vm_type page_get_type(struct page *page);
 
 unsigned page_hash(const struct hash_elem *p_, void *aux UNUSED);
@@ -0,0 +1,154 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* A pairing heap is a tree in which every node is greater than
+   or equal to its children.  The children of a node form a
+   doubly linked sibling list: a node's `child' points to its
+   first child, `next' to its next sibling, and `prev' to its
+   previous sibling, or to its parent if it is the first child.
+   The root has null `prev' and `next'.
+
+   Two heaps are melded by making the smaller root the first
+   child of the larger one.  Removing a node melds its children
+   in pairs from left to right, then melds the results from
+   right to left, which is what gives the O(log n) amortized
+   bound. */
+
+/* Melds the heaps rooted at A and B, either of which may be
+   null, and returns the new root. */
+static struct heap_elem *
+meld (struct heap *heap, struct heap_elem *a, struct heap_elem *b) {
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (heap->less (a, b, heap->aux)) {
+		struct heap_elem *t = a;
+		a = b;
+		b = t;
+	}
+
+	/* Make B the first child of A. */
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	a->next = a->prev = NULL;
+	return a;
+}
+
+/* Melds the sibling list starting at FIRST into one heap using
+   the two-pass scheme and returns its root. */
+static struct heap_elem *
+meld_pairs (struct heap *heap, struct heap_elem *first) {
+	struct heap_elem *pairs = NULL;
+	struct heap_elem *root = NULL;
+
+	/* Left to right: meld adjacent pairs, stacking the results
+	   on PAIRS through their `next' links. */
+	while (first != NULL) {
+		struct heap_elem *a = first;
+		struct heap_elem *b = a->next;
+		struct heap_elem *m;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL)
+			b->next = b->prev = NULL;
+		m = meld (heap, a, b);
+		m->next = pairs;
+		pairs = m;
+	}
+
+	/* Right to left: meld the stacked results into one. */
+	while (pairs != NULL) {
+		struct heap_elem *m = pairs;
+
+		pairs = m->next;
+		m->next = NULL;
+		root = meld (heap, root, m);
+	}
+	return root;
+}
+
+/* Initializes HEAP as an empty heap ordered by LESS given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) {
+	ASSERT (heap != NULL);
+	ASSERT (less != NULL);
+
+	heap->root = NULL;
+	heap->size = 0;
+	heap->less = less;
+	heap->aux = aux;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_push (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (heap != NULL);
+	ASSERT (elem != NULL);
+
+	elem->child = elem->next = elem->prev = NULL;
+	heap->root = meld (heap, heap->root, elem);
+	heap->size++;
+}
+
+/* Removes ELEM, which must be in HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem) {
+	struct heap_elem *sub;
+
+	ASSERT (heap != NULL);
+	ASSERT (elem != NULL);
+	ASSERT (heap->size > 0);
+
+	sub = meld_pairs (heap, elem->child);
+	if (elem == heap->root)
+		heap->root = sub;
+	else {
+		/* Unlink ELEM from its parent's list of children. */
+		if (elem->prev->child == elem)
+			elem->prev->child = elem->next;
+		else
+			elem->prev->next = elem->next;
+		if (elem->next != NULL)
+			elem->next->prev = elem->prev;
+		heap->root = meld (heap, heap->root, sub);
+	}
+	elem->child = elem->next = elem->prev = NULL;
+	heap->size--;
+}
+
+/* Removes and returns the maximum element of HEAP, or returns a
+   null pointer if HEAP is empty.  If there is more than one
+   maximum, which of them is returned is unspecified. */
+struct heap_elem *
+heap_pop_max (struct heap *heap) {
+	struct heap_elem *max = heap->root;
+
+	if (max != NULL)
+		heap_remove (heap, max);
+	return max;
+}
+
+/* Returns the maximum element of HEAP without removing it, or a
+   null pointer if HEAP is empty. */
+struct heap_elem *
+heap_max (const struct heap *heap) {
+	return heap->root;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap) {
+	return heap->size;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap) {
+	return heap->root == NULL;
+}
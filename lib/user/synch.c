@@ -0,0 +1,81 @@
+#include <synch.h>
+#include <limits.h>
+#include <syscall.h>
+
+/* The mutex is the three-state futex mutex of Drepper, "Futexes
+   Are Tricky": an unlock only calls futex_wake() if the state
+   says somebody may be sleeping, and a lock only calls
+   futex_wait() after marking that it is about to sleep. */
+
+void
+mutex_init (struct mutex *m) {
+	m->state = 0;
+}
+
+/* Returns true and locks M if M was unlocked, without sleeping. */
+bool
+mutex_trylock (struct mutex *m) {
+	int unlocked = 0;
+
+	return __atomic_compare_exchange_n (&m->state, &unlocked, 1, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+void
+mutex_lock (struct mutex *m) {
+	int state = 0;
+
+	if (__atomic_compare_exchange_n (&m->state, &state, 1, false,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return;
+
+	/* Contended: mark the mutex as having sleepers and sleep
+	   until we are the one who finds it unlocked. */
+	if (state != 2)
+		state = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	while (state != 0) {
+		futex_wait (&m->state, 2);
+		state = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	}
+}
+
+void
+mutex_unlock (struct mutex *m) {
+	if (__atomic_fetch_sub (&m->state, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n (&m->state, 0, __ATOMIC_RELEASE);
+		futex_wake (&m->state, 1);
+	}
+}
+
+void
+condvar_init (struct condvar *cv) {
+	cv->seq = 0;
+}
+
+/* Atomically releases M and waits for CV to be signaled, then
+   reacquires M.  As with any condition variable, the caller must
+   recheck its condition after returning. */
+void
+condvar_wait (struct condvar *cv, struct mutex *m) {
+	int seq = __atomic_load_n (&cv->seq, __ATOMIC_RELAXED);
+
+	mutex_unlock (m);
+	futex_wait (&cv->seq, seq);
+
+	/* Other threads may be sleeping on M too, so take it in the
+	   contended state so that our unlock wakes one of them. */
+	while (__atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE) != 0)
+		futex_wait (&m->state, 2);
+}
+
+void
+condvar_signal (struct condvar *cv) {
+	__atomic_fetch_add (&cv->seq, 1, __ATOMIC_RELEASE);
+	futex_wake (&cv->seq, 1);
+}
+
+void
+condvar_broadcast (struct condvar *cv) {
+	__atomic_fetch_add (&cv->seq, 1, __ATOMIC_RELEASE);
+	futex_wake (&cv->seq, INT_MAX);
+}
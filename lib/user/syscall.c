@@ -145,6 +145,53 @@ dup2 (int oldfd, int newfd){
 	return syscall2 (SYS_DUP2, oldfd, newfd);
 }
 
+/* Runs FUNC(AUX) in a thread made by uthread_create(), then ends
+   the thread if FUNC returns. */
+static void
+uthread_entry (uthread_func *func, void *aux) {
+	func (aux);
+	uthread_exit (0);
+}
+
+pid_t
+uthread_create (uthread_func *func, void *aux) {
+	return (pid_t) syscall3 (SYS_UTHREAD_CREATE, uthread_entry, func, aux);
+}
+
+int
+uthread_join (pid_t tid) {
+	return syscall1 (SYS_UTHREAD_JOIN, tid);
+}
+
+/* Ends the calling thread.  In a thread made by uthread_create()
+   this ends only that thread; in the main thread it ends the
+   process once the other threads are done. */
+void
+uthread_exit (int status) {
+	syscall1 (SYS_UTHREAD_EXIT, status);
+	NOT_REACHED ();
+}
+
+int
+futex_wait (int *addr, int expected) {
+	return syscall2 (SYS_FUTEX_WAIT, addr, expected);
+}
+
+int
+futex_wake (int *addr, int n) {
+	return syscall2 (SYS_FUTEX_WAKE, addr, n);
+}
+
+void
+sched_trace (void) {
+	syscall0 (SYS_SCHED_TRACE);
+}
+
+bool
+intr_stats (int vec, struct intr_stats *stats) {
+	return syscall2 (SYS_INTR_STATS, vec, stats);
+}
+
 void *
 mmap (void *addr, size_t length, int writable, int fd, off_t offset) {
 	return (void *) syscall5 (SYS_MMAP, addr, length, writable, fd, offset);
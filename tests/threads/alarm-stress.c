@@ -0,0 +1,90 @@
+/* Keeps 10,000 threads asleep at the same time, with wake-up
+   times spread over several hundred ticks so that both the root
+   wheel and the upper levels of the sleep queue are exercised.
+   Verifies that every sleeper was asleep at once and that no
+   sleeper ever woke up before its deadline. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SLEEPER_CNT 10000       /* Number of sleeping threads. */
+#define ROUNDS 3                /* Times each thread sleeps. */
+#define ROUND_TICKS 500         /* Ticks between rounds. */
+#define SPREAD_TICKS 400        /* Spread of deadlines in a round. */
+
+static thread_func sleeper;
+static int64_t start;
+static struct semaphore done;
+
+/* Updated with interrupts off. */
+static int in_flight;           /* Sleepers currently asleep. */
+static int max_in_flight;       /* Highest value of in_flight. */
+static int early_cnt;           /* Wake-ups before the deadline. */
+
+void
+test_alarm_stress (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Creating %d threads to sleep %d times each.", SLEEPER_CNT, ROUNDS);
+
+  start = timer_ticks ();
+  sema_init (&done, 0);
+  for (i = 0; i < SLEEPER_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "sleeper %d", i);
+      if (thread_create (name, PRI_DEFAULT, sleeper, (void *) (intptr_t) i)
+          == TID_ERROR)
+        fail ("could not create thread %d", i);
+    }
+
+  for (i = 0; i < SLEEPER_CNT; i++)
+    sema_down (&done);
+
+  if (max_in_flight != SLEEPER_CNT)
+    fail ("only %d of %d sleepers were asleep at once",
+          max_in_flight, SLEEPER_CNT);
+  msg ("All %d sleepers were asleep at once.", SLEEPER_CNT);
+
+  if (early_cnt != 0)
+    fail ("%d wake-ups happened before their deadline", early_cnt);
+  msg ("No sleeper woke up early.");
+}
+
+static void
+sleeper (void *id_) 
+{
+  int id = (intptr_t) id_;
+  int round;
+
+  for (round = 1; round <= ROUNDS; round++) 
+    {
+      int64_t deadline = start + round * ROUND_TICKS
+                         + (id * 37) % SPREAD_TICKS;
+      enum intr_level old_level;
+
+      old_level = intr_disable ();
+      if (++in_flight > max_in_flight)
+        max_in_flight = in_flight;
+      intr_set_level (old_level);
+
+      timer_sleep (deadline - timer_ticks ());
+
+      old_level = intr_disable ();
+      in_flight--;
+      if (timer_ticks () < deadline)
+        early_cnt++;
+      intr_set_level (old_level);
+    }
+
+  sema_up (&done);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-stress) begin
+(alarm-stress) Creating 10000 threads to sleep 3 times each.
+(alarm-stress) All 10000 sleepers were asleep at once.
+(alarm-stress) No sleeper woke up early.
+(alarm-stress) end
+EOF
+pass;
@@ -0,0 +1,50 @@
+/* Measures the cost of a context switch by having two threads of
+   equal priority hand the CPU back and forth with thread_yield().
+   Each yield switches to the other thread, so the cycles spent
+   divided by the number of yields is the cost of one trip through
+   schedule() and thread_launch(). */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define YIELDS 20000            /* Yields per thread. */
+
+static thread_func yielder;
+static struct semaphore done;
+
+void
+test_context_switch (void) 
+{
+  uint64_t start, cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  thread_create ("yielder", PRI_DEFAULT, yielder, NULL);
+
+  start = rdtsc ();
+  for (i = 0; i < YIELDS; i++)
+    thread_yield ();
+  sema_down (&done);
+  cycles = rdtsc () - start;
+
+  msg ("%llu cycles per context switch.",
+       (unsigned long long) (cycles / (2 * YIELDS)));
+}
+
+static void
+yielder (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < YIELDS; i++)
+    thread_yield ();
+  sema_up (&done);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing context switch timing in output"
+  unless grep (/^\(context-switch\) \d+ cycles per context switch\.$/,
+	       @output);
+
+pass;
@@ -0,0 +1,104 @@
+/* Runs two periodic EDF tasks, with a total bandwidth of 50%,
+   against three CPU-bound threads at the default priority, and
+   checks that every job of both tasks finishes by its deadline.
+   Also checks that admission control turns away a third task
+   that would push the EDF bandwidth past EDF_UTIL_MAX. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define JOBS 10                 /* Jobs per task. */
+#define HOGS 3                  /* CPU-bound threads. */
+
+struct task
+  {
+    const char *name;
+    int64_t runtime;            /* Budget per period, in ticks. */
+    int64_t period;             /* Period, in ticks. */
+    int64_t work;               /* Ticks of work per job. */
+    int missed;                 /* Jobs that finished late. */
+    bool admitted;
+  };
+
+static thread_func edf_task, hog;
+static struct semaphore done;
+static volatile bool stop;
+
+void
+test_edf_deadline (void) 
+{
+  struct task tasks[2] = {
+    { "A", 3, 10, 1, 0, false },
+    { "B", 4, 20, 2, 0, false },
+  };
+  struct semaphore hogs_done;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  sema_init (&hogs_done, 0);
+  for (i = 0; i < HOGS; i++)
+    thread_create ("hog", PRI_DEFAULT, hog, &hogs_done);
+
+  /* The tasks run at once and declare themselves before we go on. */
+  for (i = 0; i < 2; i++)
+    thread_create (tasks[i].name, PRI_DEFAULT + 1, edf_task, &tasks[i]);
+
+  if (thread_set_deadline (5, 10))
+    fail ("Task C admitted at 100% EDF bandwidth.");
+  msg ("Task C rejected by admission control.");
+
+  for (i = 0; i < 2; i++)
+    sema_down (&done);
+  stop = true;
+  for (i = 0; i < HOGS; i++)
+    sema_down (&hogs_done);
+
+  for (i = 0; i < 2; i++)
+    {
+      if (!tasks[i].admitted)
+        fail ("Task %s was not admitted.", tasks[i].name);
+      if (tasks[i].missed == 0)
+        msg ("Task %s met all %d deadlines.", tasks[i].name, JOBS);
+      else
+        msg ("Task %s missed %d of %d deadlines.",
+             tasks[i].name, tasks[i].missed, JOBS);
+    }
+}
+
+static void
+edf_task (void *task_) 
+{
+  struct task *task = task_;
+  int i;
+
+  task->admitted = thread_set_deadline (task->runtime, task->period);
+  if (task->admitted)
+    for (i = 0; i < JOBS; i++) 
+      {
+        int64_t start = timer_ticks ();
+
+        while (timer_elapsed (start) < task->work)
+          continue;
+        if (!thread_wait_period ())
+          task->missed++;
+      }
+  thread_set_deadline (0, 0);
+  sema_up (&done);
+}
+
+static void
+hog (void *hogs_done_) 
+{
+  struct semaphore *hogs_done = hogs_done_;
+
+  while (!stop)
+    continue;
+  sema_up (hogs_done);
+}
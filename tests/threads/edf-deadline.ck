@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-deadline) begin
+(edf-deadline) Task C rejected by admission control.
+(edf-deadline) Task A met all 10 deadlines.
+(edf-deadline) Task B met all 10 deadlines.
+(edf-deadline) end
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Runs an EDF task with a budget of 2 ticks every 10 that never
+   ends its job and spins instead, and checks that a thread at the
+   default priority still gets to run while it does.  The task
+   spins until that thread tells it to stop, or for 200 ticks if
+   it never does. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPIN_TICKS 200          /* Longest the task spins. */
+
+static thread_func overrun;
+static struct semaphore done;
+static volatile bool stop;
+static bool stopped;
+
+void
+test_edf_overrun (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  thread_create ("overrun", PRI_DEFAULT, overrun, NULL);
+
+  /* Let the task start.  From then on we run only while it is
+     throttled. */
+  timer_sleep (1);
+  stop = true;
+
+  sema_down (&done);
+  if (!stopped)
+    fail ("Task spun for %d ticks without letting us run.", SPIN_TICKS);
+  msg ("Ran while the EDF task overran its budget.");
+}
+
+static void
+overrun (void *aux UNUSED) 
+{
+  int64_t start;
+
+  if (!thread_set_deadline (2, 10))
+    fail ("Task was not admitted.");
+
+  start = timer_ticks ();
+  while (!stop && timer_elapsed (start) < SPIN_TICKS)
+    continue;
+  stopped = stop;
+
+  thread_set_deadline (0, 0);
+  sema_up (&done);
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-overrun) begin
+(edf-overrun) Ran while the EDF task overran its budget.
+(edf-overrun) end
+EOF
+pass;
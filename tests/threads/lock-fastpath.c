@@ -0,0 +1,72 @@
+/* Measures the cost of an uncontended lock_acquire()/lock_release()
+   pair, which should take the compare-and-swap fast path, and of a
+   sema_down()/sema_up() pair for comparison.  Then checks that a
+   contended lock still hands off to a waiting thread. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define ITERATIONS 100000       /* Pairs measured per primitive. */
+
+static thread_func contender;
+static struct lock lock;
+static struct semaphore sema;
+static bool contender_ran;
+
+void
+test_lock_fastpath (void) 
+{
+  uint64_t start, lock_cycles, sema_cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  sema_init (&sema, 1);
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      lock_acquire (&lock);
+      lock_release (&lock);
+    }
+  lock_cycles = (rdtsc () - start) / ITERATIONS;
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      sema_down (&sema);
+      sema_up (&sema);
+    }
+  sema_cycles = (rdtsc () - start) / ITERATIONS;
+
+  msg ("lock: %llu cycles per acquire/release pair.",
+       (unsigned long long) lock_cycles);
+  msg ("semaphore: %llu cycles per down/up pair.",
+       (unsigned long long) sema_cycles);
+
+  /* The contender must block on the lock we hold and get it as
+     soon as we release it. */
+  lock_acquire (&lock);
+  thread_create ("contender", PRI_DEFAULT + 1, contender, NULL);
+  if (contender_ran)
+    fail ("contender acquired a held lock");
+  lock_release (&lock);
+  if (!contender_ran)
+    fail ("contender was not woken by lock_release()");
+  msg ("Contended lock was handed off.");
+}
+
+static void
+contender (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  contender_ran = true;
+  lock_release (&lock);
+}
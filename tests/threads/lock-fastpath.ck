@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing lock timing in output"
+  unless grep (/^\(lock-fastpath\) lock: \d+ cycles per acquire\/release pair\.$/,
+	       @output);
+fail "missing semaphore timing in output"
+  unless grep (/^\(lock-fastpath\) semaphore: \d+ cycles per down\/up pair\.$/,
+	       @output);
+fail "contended lock was not handed off"
+  unless grep ($_ eq '(lock-fastpath) Contended lock was handed off.', @output);
+
+pass;
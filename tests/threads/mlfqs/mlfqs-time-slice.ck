@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing throughput in output"
+  unless grep (/^\(mlfqs-time-slice\) throughput: \d+ iterations per tick\.$/,
+	       @output);
+fail "missing response time in output"
+  unless grep (/^\(mlfqs-time-slice\) response: \d+\.\d\d ticks average, \d+ ticks worst\.$/,
+	       @output);
+
+pass;
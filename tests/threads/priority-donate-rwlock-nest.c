@@ -0,0 +1,102 @@
+/* Donation through a chain of lock -> rwlock -> lock.
+
+   The main thread acquires lock A.  A writer takes rwlock R for
+   writing and blocks on lock A.  A reader takes lock B and blocks
+   reading R.  A high-priority thread then blocks on lock B.  Its
+   priority has to reach the main thread by way of the reader,
+   which waits on R, and the writer, which holds R and waits on
+   A. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+struct locks 
+  {
+    struct lock *a;
+    struct lock *b;
+    struct rwlock *rw;
+  };
+
+static thread_func writer_thread_func;
+static thread_func reader_thread_func;
+static thread_func high_thread_func;
+
+void
+test_priority_donate_rwlock_nest (void) 
+{
+  struct lock a, b;
+  struct rwlock rw;
+  struct locks locks;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&a);
+  lock_init (&b);
+  rwlock_init (&rw);
+  locks.a = &a;
+  locks.b = &b;
+  locks.rw = &rw;
+
+  lock_acquire (&a);
+
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread_func, &locks);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+
+  thread_create ("reader", PRI_DEFAULT + 4, reader_thread_func, &locks);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 4, thread_get_priority ());
+
+  thread_create ("high", PRI_DEFAULT + 6, high_thread_func, &b);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 6, thread_get_priority ());
+
+  lock_release (&a);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+  msg ("writer, reader, high must already have finished.");
+}
+
+static void
+writer_thread_func (void *locks_) 
+{
+  struct locks *locks = locks_;
+
+  rwlock_acquire_write (locks->rw);
+  lock_acquire (locks->a);
+  msg ("writer: got lock A");
+  lock_release (locks->a);
+  rwlock_release_write (locks->rw);
+  msg ("writer: done");
+}
+
+static void
+reader_thread_func (void *locks_) 
+{
+  struct locks *locks = locks_;
+
+  lock_acquire (locks->b);
+  rwlock_acquire_read (locks->rw);
+  msg ("reader: got the rwlock");
+  rwlock_release_read (locks->rw);
+  lock_release (locks->b);
+  msg ("reader: done");
+}
+
+static void
+high_thread_func (void *lock_) 
+{
+  struct lock *lock = lock_;
+
+  lock_acquire (lock);
+  msg ("high: got lock B");
+  lock_release (lock);
+  msg ("high: done");
+}
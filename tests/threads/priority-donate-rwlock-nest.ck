@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-rwlock-nest) begin
+(priority-donate-rwlock-nest) This thread should have priority 33.  Actual priority: 33.
+(priority-donate-rwlock-nest) This thread should have priority 35.  Actual priority: 35.
+(priority-donate-rwlock-nest) This thread should have priority 37.  Actual priority: 37.
+(priority-donate-rwlock-nest) writer: got lock A
+(priority-donate-rwlock-nest) reader: got the rwlock
+(priority-donate-rwlock-nest) high: got lock B
+(priority-donate-rwlock-nest) high: done
+(priority-donate-rwlock-nest) reader: done
+(priority-donate-rwlock-nest) writer: done
+(priority-donate-rwlock-nest) This thread should have priority 31.  Actual priority: 31.
+(priority-donate-rwlock-nest) writer, reader, high must already have finished.
+(priority-donate-rwlock-nest) end
+EOF
+pass;
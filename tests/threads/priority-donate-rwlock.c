@@ -0,0 +1,64 @@
+/* The main thread holds an rwlock for reading and an ordinary
+   lock.  A higher-priority writer blocks on the rwlock and a
+   thread in between blocks on the lock, both donating to the
+   main thread.  Releasing the lock must not drop the donation
+   that the writer made through the rwlock. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func writer_thread_func;
+static thread_func locker_thread_func;
+
+void
+test_priority_donate_rwlock (void) 
+{
+  struct rwlock rw;
+  struct lock lock;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+  lock_init (&lock);
+  rwlock_acquire_read (&rw);
+  lock_acquire (&lock);
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread_func, &rw);
+  thread_create ("locker", PRI_DEFAULT + 1, locker_thread_func, &lock);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+  lock_release (&lock);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+  rwlock_release_read (&rw);
+  msg ("writer, locker must already have finished, in that order.");
+  msg ("This should be the last line before finishing this test.");
+}
+
+static void
+writer_thread_func (void *rw_) 
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_acquire_write (rw);
+  msg ("writer: got the rwlock");
+  rwlock_release_write (rw);
+  msg ("writer: done");
+}
+
+static void
+locker_thread_func (void *lock_) 
+{
+  struct lock *lock = lock_;
+
+  lock_acquire (lock);
+  msg ("locker: got the lock");
+  lock_release (lock);
+  msg ("locker: done");
+}
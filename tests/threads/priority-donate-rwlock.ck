@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-rwlock) begin
+(priority-donate-rwlock) This thread should have priority 33.  Actual priority: 33.
+(priority-donate-rwlock) This thread should have priority 33.  Actual priority: 33.
+(priority-donate-rwlock) writer: got the rwlock
+(priority-donate-rwlock) writer: done
+(priority-donate-rwlock) locker: got the lock
+(priority-donate-rwlock) locker: done
+(priority-donate-rwlock) writer, locker must already have finished, in that order.
+(priority-donate-rwlock) This should be the last line before finishing this test.
+(priority-donate-rwlock) end
+EOF
+pass;
@@ -0,0 +1,128 @@
+/* Measures how long sema_up() and cond_signal() take to pick the
+   highest-priority waiter with WAITER_CNT threads waiting, and
+   checks that sema_up() wakes the waiters by priority, earliest
+   first among equal priorities. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define WAITER_CNT 1000
+
+static thread_func sema_waiter;
+static thread_func cond_waiter;
+static struct semaphore sema;
+static struct lock lock;
+static struct condition cond;
+static int woken[WAITER_CNT];   /* Waiter indexes in wake-up order. */
+static int woken_cnt;
+
+/* Returns the priority of waiter I.  Waiters share each priority
+   between PRI_MIN + 1 and PRI_MAX - 1 in a scattered order. */
+static int
+waiter_priority (int i) 
+{
+  return PRI_MIN + 1 + (i * 17) % (PRI_MAX - PRI_MIN - 1);
+}
+
+/* Starts WAITER_CNT threads running FUNC.  We run at PRI_MIN, so
+   each runs until it blocks before the next one is created. */
+static void
+start_waiters (thread_func *func) 
+{
+  int i;
+
+  woken_cnt = 0;
+  thread_set_priority (PRI_MIN);
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, waiter_priority (i), func, (void *) (intptr_t) i);
+    }
+}
+
+void
+test_sema_waiters (void) 
+{
+  uint64_t start, cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&sema, 0);
+  lock_init (&lock);
+  cond_init (&cond);
+
+  /* At PRI_MAX nobody we wake can preempt us, so only the cost of
+     picking and unblocking the waiter is measured. */
+  start_waiters (sema_waiter);
+  thread_set_priority (PRI_MAX);
+  start = rdtsc ();
+  for (i = 0; i < WAITER_CNT; i++)
+    sema_up (&sema);
+  cycles = (rdtsc () - start) / WAITER_CNT;
+  thread_set_priority (PRI_MIN);
+
+  msg ("sema_up: %llu cycles per wakeup with %d waiters.",
+       (unsigned long long) cycles, WAITER_CNT);
+  if (woken_cnt != WAITER_CNT)
+    fail ("%d of %d semaphore waiters woke up", woken_cnt, WAITER_CNT);
+
+  /* Above, the waiters ran in the scheduler's order once we went
+     back to PRI_MIN.  Staying at PRI_MIN instead, each waiter we
+     wake preempts us and logs itself before the next sema_up(),
+     so the log shows the order the semaphore picked. */
+  start_waiters (sema_waiter);
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      sema_up (&sema);
+      if (woken_cnt != i + 1)
+        fail ("waiter did not run right after sema_up()");
+    }
+  for (i = 1; i < WAITER_CNT; i++)
+    {
+      int a = woken[i - 1], b = woken[i];
+      if (waiter_priority (a) < waiter_priority (b)
+          || (waiter_priority (a) == waiter_priority (b) && a > b))
+        fail ("waiter %d woke before waiter %d", a, b);
+    }
+  msg ("Semaphore waiters woke in priority order.");
+
+  start_waiters (cond_waiter);
+  thread_set_priority (PRI_MAX);
+  lock_acquire (&lock);
+  start = rdtsc ();
+  cond_broadcast (&cond, &lock);
+  cycles = (rdtsc () - start) / WAITER_CNT;
+  lock_release (&lock);
+  thread_set_priority (PRI_MIN);
+
+  msg ("cond_signal: %llu cycles per wakeup with %d waiters.",
+       (unsigned long long) cycles, WAITER_CNT);
+  if (woken_cnt != WAITER_CNT)
+    fail ("%d of %d condition waiters woke up", woken_cnt, WAITER_CNT);
+  msg ("All condition waiters woke up.");
+
+  thread_set_priority (PRI_DEFAULT);
+}
+
+static void
+sema_waiter (void *aux) 
+{
+  sema_down (&sema);
+  woken[woken_cnt++] = (intptr_t) aux;
+}
+
+static void
+cond_waiter (void *aux) 
+{
+  lock_acquire (&lock);
+  cond_wait (&cond, &lock);
+  woken[woken_cnt++] = (intptr_t) aux;
+  lock_release (&lock);
+}
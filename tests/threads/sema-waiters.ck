@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing sema_up timing in output"
+  unless grep (/^\(sema-waiters\) sema_up: \d+ cycles per wakeup with 1000 waiters\.$/,
+	       @output);
+fail "semaphore waiters did not wake in priority order"
+  unless grep ($_ eq '(sema-waiters) Semaphore waiters woke in priority order.',
+	       @output);
+fail "missing cond_signal timing in output"
+  unless grep (/^\(sema-waiters\) cond_signal: \d+ cycles per wakeup with 1000 waiters\.$/,
+	       @output);
+fail "condition waiters did not all wake up"
+  unless grep ($_ eq '(sema-waiters) All condition waiters woke up.', @output);
+
+pass;
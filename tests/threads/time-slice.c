@@ -0,0 +1,103 @@
+/* Measures the throughput against response time trade-off of
+   the time slice.  Four CPU-bound threads count as fast as they
+   can while an interactive thread sleeps for one tick at a time
+   and records how many ticks late it gets the CPU back.
+
+   time-slice runs this under the priority scheduler, where every
+   thread gets the same base slice, and mlfqs-time-slice under
+   the MLFQS, where CPU-bound threads drift to low priorities and
+   longer slices.  Run either with -ts=TICKS to change the base
+   slice. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOG_CNT 4               /* CPU-bound threads. */
+#define SAMPLES 200             /* Sleeps by the interactive thread. */
+
+static thread_func hog, interactive;
+static void test_time_slice_common (void);
+
+static volatile bool stop;
+static struct semaphore done;
+static int64_t latency_sum, latency_max;
+
+void
+test_time_slice (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+  test_time_slice_common ();
+}
+
+void
+test_mlfqs_time_slice (void) 
+{
+  ASSERT (thread_mlfqs);
+  test_time_slice_common ();
+}
+
+static void
+test_time_slice_common (void) 
+{
+  long long counts[HOG_CNT];
+  long long total = 0;
+  int64_t start, elapsed;
+  int i;
+
+  msg ("Base time slice is %u ticks.", thread_time_slice);
+
+  sema_init (&done, 0);
+  start = timer_ticks ();
+  for (i = 0; i < HOG_CNT; i++)
+    thread_create ("hog", PRI_DEFAULT, hog, &counts[i]);
+  thread_create ("interactive", PRI_DEFAULT, interactive, NULL);
+
+  sema_down (&done);
+  stop = true;
+  for (i = 0; i < HOG_CNT; i++)
+    sema_down (&done);
+  elapsed = timer_elapsed (start);
+
+  for (i = 0; i < HOG_CNT; i++)
+    total += counts[i];
+  msg ("throughput: %lld iterations per tick.", total / elapsed);
+  msg ("response: %lld.%02lld ticks average, %lld ticks worst.",
+       latency_sum / SAMPLES, latency_sum * 100 / SAMPLES % 100,
+       latency_max);
+}
+
+static void
+hog (void *count_) 
+{
+  long long *count = count_;
+  long long n = 0;
+
+  while (!stop)
+    n++;
+  *count = n;
+  sema_up (&done);
+}
+
+static void
+interactive (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < SAMPLES; i++) 
+    {
+      int64_t wake = timer_ticks () + 1;
+      int64_t late;
+
+      timer_sleep (1);
+      late = timer_ticks () - wake;
+      latency_sum += late;
+      if (late > latency_max)
+        latency_max = late;
+    }
+  sema_up (&done);
+}
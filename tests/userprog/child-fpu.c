@@ -0,0 +1,17 @@
+/* Child process run by fpu-fork, through exec after its parent
+   loaded a value into an SSE register.  Exits with status 0 if
+   that register starts out clear. */
+
+#include <stdint.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-fpu";
+
+int
+main (void)
+{
+  uint64_t value;
+
+  asm volatile ("movq %%xmm0, %0" : "=m" (value));
+  return value == 0 ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+/* Loads a value into an SSE register, forks and checks that the
+   child starts with the same value while the parent keeps its
+   own.  A second child execs child-fpu, which must start with a
+   clean register instead. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PARENT_VALUE 0x0123456789abcdefULL
+#define CHILD_VALUE 0xfedcba9876543210ULL
+
+static void
+set_xmm0 (uint64_t value)
+{
+  asm volatile ("movq %0, %%xmm0" : : "m" (value));
+}
+
+static uint64_t
+get_xmm0 (void)
+{
+  uint64_t value;
+
+  asm volatile ("movq %%xmm0, %0" : "=m" (value));
+  return value;
+}
+
+void
+test_main (void)
+{
+  pid_t pid;
+
+  set_xmm0 (PARENT_VALUE);
+  pid = fork ("child");
+  if (pid == 0)
+    {
+      if (get_xmm0 () != PARENT_VALUE)
+        exit (1);
+      set_xmm0 (CHILD_VALUE);
+      exit (get_xmm0 () == CHILD_VALUE ? 0 : 2);
+    }
+  CHECK (pid > 0, "fork");
+  CHECK (wait (pid) == 0, "child inherited the FPU state");
+  CHECK (get_xmm0 () == PARENT_VALUE, "parent kept its FPU state");
+
+  pid = fork ("child-fpu");
+  if (pid == 0)
+    exec ("child-fpu");
+  CHECK (pid > 0, "fork");
+  CHECK (wait (pid) == 0, "exec started with a clean FPU state");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-fork) begin
+(fpu-fork) fork
+child: exit(0)
+(fpu-fork) child inherited the FPU state
+(fpu-fork) parent kept its FPU state
+(fpu-fork) fork
+child-fpu: exit(0)
+(fpu-fork) exec started with a clean FPU state
+(fpu-fork) end
+fpu-fork: exit(0)
+EOF
+pass;
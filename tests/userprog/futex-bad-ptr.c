@@ -0,0 +1,16 @@
+/* Passes a misaligned pointer to the futex_wait system call,
+   which must cause the process to be terminated with exit code
+   -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static int words[2];
+
+  msg ("futex_wait(misaligned): %d",
+       futex_wait ((int *) ((char *) words + 1), 0));
+}
@@ -0,0 +1,64 @@
+/* Several threads of one process increment a shared counter under
+   a futex-based mutex, so that they contend for it, then hand a
+   token around a ring with a condition variable. */
+
+#include <stdint.h>
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITERS 2000
+#define ROUNDS 5
+
+static struct mutex m = MUTEX_INITIALIZER;
+static struct condvar cv = CONDVAR_INITIALIZER;
+static int counter;
+static int turn;
+
+static void
+contend (void *aux)
+{
+  int id = (int) (intptr_t) aux;
+
+  for (int i = 0; i < ITERS; i++)
+    {
+      mutex_lock (&m);
+      int c = counter;
+      /* Widen the window in which the timer can preempt us. */
+      for (volatile int spin = 0; spin < 100; spin++)
+        continue;
+      counter = c + 1;
+      mutex_unlock (&m);
+    }
+
+  for (int r = 0; r < ROUNDS; r++)
+    {
+      mutex_lock (&m);
+      while (turn % THREAD_CNT != id)
+        condvar_wait (&cv, &m);
+      turn++;
+      condvar_broadcast (&cv);
+      mutex_unlock (&m);
+    }
+}
+
+void
+test_main (void) 
+{
+  pid_t tids[THREAD_CNT];
+
+  for (int i = 0; i < THREAD_CNT; i++)
+    {
+      tids[i] = uthread_create (contend, (void *) (intptr_t) i);
+      CHECK (tids[i] != PID_ERROR, "create thread %d", i);
+    }
+  for (int i = 0; i < THREAD_CNT; i++)
+    CHECK (uthread_join (tids[i]) == 0, "join thread %d", i);
+
+  CHECK (counter == THREAD_CNT * ITERS, "counter is %d", counter);
+  CHECK (turn == THREAD_CNT * ROUNDS, "token went around %d times",
+         turn / THREAD_CNT);
+  CHECK (m.state == 0, "mutex is free at the end");
+}
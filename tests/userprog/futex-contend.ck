@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-contend) begin
+(futex-contend) create thread 0
+(futex-contend) create thread 1
+(futex-contend) create thread 2
+(futex-contend) create thread 3
+(futex-contend) join thread 0
+(futex-contend) join thread 1
+(futex-contend) join thread 2
+(futex-contend) join thread 3
+(futex-contend) counter is 8000
+(futex-contend) token went around 5 times
+(futex-contend) mutex is free at the end
+(futex-contend) end
+futex-contend: exit(0)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Exercises futexes and the mutex and condition variable built
+   on them without any contention, where no call may block. */
+
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex m = MUTEX_INITIALIZER;
+  struct condvar cv = CONDVAR_INITIALIZER;
+  int word = 5;
+
+  msg ("futex_wait on a changed value: %d", futex_wait (&word, 4));
+  msg ("futex_wake with no waiters: %d", futex_wake (&word, 1));
+
+  mutex_lock (&m);
+  CHECK (!mutex_trylock (&m), "trylock of a held mutex fails");
+  mutex_unlock (&m);
+  CHECK (mutex_trylock (&m), "trylock of a free mutex succeeds");
+  mutex_unlock (&m);
+  CHECK (m.state == 0, "mutex is free after unlock");
+
+  condvar_signal (&cv);
+  condvar_broadcast (&cv);
+  CHECK (cv.seq == 2, "signals without waiters only bump the sequence");
+}
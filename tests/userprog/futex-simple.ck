@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-simple) begin
+(futex-simple) futex_wait on a changed value: -1
+(futex-simple) futex_wake with no waiters: 0
+(futex-simple) trylock of a held mutex fails
+(futex-simple) trylock of a free mutex succeeds
+(futex-simple) mutex is free after unlock
+(futex-simple) signals without waiters only bump the sequence
+(futex-simple) end
+futex-simple: exit(0)
+EOF
+pass;
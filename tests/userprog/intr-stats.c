@@ -0,0 +1,23 @@
+/* Reads the interrupt latency statistics of the timer and of
+   system calls and checks that they are consistent. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct intr_stats a, b;
+
+  CHECK (intr_stats (INTR_STAT_SYSCALL, &a), "read syscall stats");
+  CHECK (intr_stats (INTR_STAT_SYSCALL, &b), "read them again");
+  CHECK (b.count > a.count, "syscall count went up");
+  CHECK (b.max_cycles >= b.max_off_cycles && b.cycles >= b.max_cycles,
+         "syscall cycle totals are consistent");
+
+  CHECK (intr_stats (0x20, &a), "read timer stats");
+  CHECK (a.count > 0, "timer interrupt was taken");
+
+  CHECK (!intr_stats (INTR_STAT_SYSCALL + 1, &a), "bad vector is rejected");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(intr-stats) begin
+(intr-stats) read syscall stats
+(intr-stats) read them again
+(intr-stats) syscall count went up
+(intr-stats) syscall cycle totals are consistent
+(intr-stats) read timer stats
+(intr-stats) timer interrupt was taken
+(intr-stats) bad vector is rejected
+(intr-stats) end
+intr-stats: exit(0)
+EOF
+pass;
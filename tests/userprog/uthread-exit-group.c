@@ -0,0 +1,52 @@
+/* Ends processes that still have threads asleep on a futex and
+   spinning in user mode.  A fault in a non-main thread must end
+   the whole child process with -1, and returning from main() must
+   end this one, without waiting for threads that never finish. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int never;
+
+static void
+sleeper (void *aux UNUSED)
+{
+  for (;;)
+    futex_wait (&never, 0);
+}
+
+static void
+spinner (void *aux UNUSED)
+{
+  for (;;)
+    continue;
+}
+
+static void
+faulter (void *aux UNUSED)
+{
+  for (volatile int spin = 0; spin < 100000; spin++)
+    continue;
+  *(volatile int *) NULL = 42;
+  fail ("should have died");
+}
+
+void
+test_main (void)
+{
+  pid_t child = fork ("child");
+
+  if (child == 0)
+    {
+      uthread_create (sleeper, NULL);
+      uthread_create (spinner, NULL);
+      uthread_create (faulter, NULL);
+      for (;;)
+        futex_wait (&never, 0);
+    }
+  msg ("wait(child) = %d", wait (child));
+
+  CHECK (uthread_create (sleeper, NULL) != PID_ERROR, "create sleeper");
+  CHECK (uthread_create (spinner, NULL) != PID_ERROR, "create spinner");
+}
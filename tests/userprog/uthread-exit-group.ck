@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-exit-group) begin
+child: exit(-1)
+(uthread-exit-group) wait(child) = -1
+(uthread-exit-group) create sleeper
+(uthread-exit-group) create spinner
+(uthread-exit-group) end
+uthread-exit-group: exit(0)
+EOF
+pass;
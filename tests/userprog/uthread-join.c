@@ -0,0 +1,50 @@
+/* Starts threads that sum disjoint parts of an array in the shared
+   address space, then joins them and checks their exit statuses
+   and the sums they left behind. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define PART 256
+
+static int numbers[THREAD_CNT * PART];
+static int sums[THREAD_CNT];
+
+static void
+sum_part (void *aux)
+{
+  int i = (int) (intptr_t) aux;
+  int sum = 0;
+
+  for (int j = 0; j < PART; j++)
+    sum += numbers[i * PART + j];
+  sums[i] = sum;
+  uthread_exit (i + 10);
+}
+
+void
+test_main (void) 
+{
+  pid_t tids[THREAD_CNT];
+  int total = 0;
+
+  for (int i = 0; i < THREAD_CNT * PART; i++)
+    numbers[i] = i;
+
+  for (int i = 0; i < THREAD_CNT; i++)
+    {
+      tids[i] = uthread_create (sum_part, (void *) (intptr_t) i);
+      CHECK (tids[i] != PID_ERROR, "create thread %d", i);
+    }
+  for (int i = 0; i < THREAD_CNT; i++)
+    msg ("join thread %d: %d", i, uthread_join (tids[i]));
+  CHECK (uthread_join (tids[0]) == -1, "second join fails");
+
+  for (int i = 0; i < THREAD_CNT; i++)
+    total += sums[i];
+  CHECK (total == THREAD_CNT * PART * (THREAD_CNT * PART - 1) / 2,
+         "sum is %d", total);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-join) begin
+(uthread-join) create thread 0
+(uthread-join) create thread 1
+(uthread-join) create thread 2
+(uthread-join) create thread 3
+(uthread-join) join thread 0: 10
+(uthread-join) join thread 1: 11
+(uthread-join) join thread 2: 12
+(uthread-join) join thread 3: 13
+(uthread-join) second join fails
+(uthread-join) sum is 523776
+(uthread-join) end
+uthread-join: exit(0)
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* Forks many children before waiting for any of them, then waits
+   for them in reverse order, so that each wait has to find its
+   child among many exited-but-unreaped siblings. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 40
+
+void
+test_main (void) 
+{
+  pid_t pids[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      pids[i] = fork ("child");
+      if (pids[i] == 0)
+        exit (i);
+      CHECK (pids[i] != PID_ERROR, "fork child %d", i);
+    }
+
+  for (i = CHILD_CNT - 1; i >= 0; i--)
+    if (wait (pids[i]) != i)
+      fail ("wrong exit status for child %d", i);
+  msg ("all children reaped in reverse order");
+
+  CHECK (wait (pids[0]) == -1, "second wait fails");
+}
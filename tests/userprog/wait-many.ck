@@ -0,0 +1,51 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(wait-many) begin
+(wait-many) fork child 0
+(wait-many) fork child 1
+(wait-many) fork child 2
+(wait-many) fork child 3
+(wait-many) fork child 4
+(wait-many) fork child 5
+(wait-many) fork child 6
+(wait-many) fork child 7
+(wait-many) fork child 8
+(wait-many) fork child 9
+(wait-many) fork child 10
+(wait-many) fork child 11
+(wait-many) fork child 12
+(wait-many) fork child 13
+(wait-many) fork child 14
+(wait-many) fork child 15
+(wait-many) fork child 16
+(wait-many) fork child 17
+(wait-many) fork child 18
+(wait-many) fork child 19
+(wait-many) fork child 20
+(wait-many) fork child 21
+(wait-many) fork child 22
+(wait-many) fork child 23
+(wait-many) fork child 24
+(wait-many) fork child 25
+(wait-many) fork child 26
+(wait-many) fork child 27
+(wait-many) fork child 28
+(wait-many) fork child 29
+(wait-many) fork child 30
+(wait-many) fork child 31
+(wait-many) fork child 32
+(wait-many) fork child 33
+(wait-many) fork child 34
+(wait-many) fork child 35
+(wait-many) fork child 36
+(wait-many) fork child 37
+(wait-many) fork child 38
+(wait-many) fork child 39
+(wait-many) all children reaped in reverse order
+(wait-many) second wait fails
+(wait-many) end
+EOF
+pass;
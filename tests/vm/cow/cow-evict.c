@@ -0,0 +1,67 @@
+/* Forks a process whose data segment fills a good part of memory,
+   so that parent and child share all of it copy-on-write, and
+   then has the child touch even more memory of its own.  The
+   shared frames have to be evicted to make room; afterwards both
+   processes must still see the data they had.
+   For this test, Pintos memory size is 10MB. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define SHARED_CNT 768          /* 3 MB, shared by fork. */
+#define PRIVATE_CNT 1536        /* 6 MB, touched by the child alone. */
+
+static char shared[SHARED_CNT * PAGE_SIZE];
+static char private[PRIVATE_CNT * PAGE_SIZE];
+
+/* Returns true if page I of SHARED holds what test_main() wrote. */
+static bool
+shared_ok (size_t i)
+{
+	return shared[i * PAGE_SIZE] == (char) i
+	       && shared[i * PAGE_SIZE + PAGE_SIZE - 1] == (char) ~i;
+}
+
+static int
+child_main (void)
+{
+	size_t i;
+
+	for (i = 0; i < PRIVATE_CNT; i++)
+		private[i * PAGE_SIZE] = (char) i;
+	for (i = 0; i < SHARED_CNT; i++)
+		if (!shared_ok (i))
+			return 1;
+	for (i = 0; i < PRIVATE_CNT; i++)
+		if (private[i * PAGE_SIZE] != (char) i)
+			return 2;
+	return 0;
+}
+
+void
+test_main (void)
+{
+	pid_t child;
+	size_t i;
+
+	for (i = 0; i < SHARED_CNT; i++) {
+		shared[i * PAGE_SIZE] = (char) i;
+		shared[i * PAGE_SIZE + PAGE_SIZE - 1] = (char) ~i;
+	}
+
+	child = fork ("child");
+	if (child == 0)
+		exit (child_main ());
+	CHECK (child > 0, "fork");
+	CHECK (wait (child) == 0, "wait for child");
+
+	for (i = 0; i < SHARED_CNT; i++)
+		if (!shared_ok (i))
+			fail ("parent's page %zu is inconsistent", i);
+	msg ("parent's data is consistent");
+}
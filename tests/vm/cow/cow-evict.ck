@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-evict) begin
+(cow-evict) fork
+(cow-evict) wait for child
+(cow-evict) parent's data is consistent
+(cow-evict) end
+EOF
+pass;
@@ -0,0 +1,72 @@
+/* Forks a process with a large dirty data segment several times and
+   reports how long each fork takes.  With copy-on-write, the cost
+   should not depend on how much the parent has touched.  Each child
+   checks a spread of pages and writes one of them, which the parent
+   must not see. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_CNT 256
+#define FORK_CNT 10
+
+static char buf[PAGE_CNT * 4096];
+
+/* Checks every 15th page of BUF, and the last one, and then writes
+   to the first page.  Returns the exit status for the child. */
+static int
+child_main (void)
+{
+	size_t page;
+
+	for (page = 0; page < PAGE_CNT; page += 15)
+		if (buf[page * 4096] != (char) page)
+			return 1;
+	if (buf[(PAGE_CNT - 1) * 4096] != (char) (PAGE_CNT - 1))
+		return 1;
+	buf[0] = 'c';
+	return buf[0] == 'c' ? 0 : 1;
+}
+
+static inline uint64_t
+rdtsc (void)
+{
+	uint32_t lo, hi;
+	asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
+void
+test_main (void)
+{
+	uint64_t start, total = 0;
+	size_t i;
+	int f;
+
+	for (i = 0; i < sizeof buf; i += 4096)
+		buf[i] = (char) (i / 4096);
+
+	for (f = 0; f < FORK_CNT; f++) {
+		pid_t child;
+
+		start = rdtsc ();
+		child = fork ("child");
+		if (child == 0)
+			exit (child_main ());
+		total += rdtsc () - start;
+		CHECK (child > 0, "fork");
+		if (wait (child) != 0)
+			fail ("child saw wrong data");
+		if (buf[0] != 0)
+			fail ("parent saw the child's write");
+	}
+
+	buf[0] = 'x';
+	CHECK (buf[0] == 'x', "parent can still write");
+	msg ("fork: %llu cycles per fork of %d dirty pages",
+	     (unsigned long long) (total / FORK_CNT), PAGE_CNT);
+}
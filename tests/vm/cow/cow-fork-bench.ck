@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "child saw wrong data"
+  if grep (/child saw wrong data/, @output);
+fail "parent saw the child's write"
+  if grep (/parent saw the child's write/, @output);
+fail "missing fork timing in output"
+  unless grep (/^\(cow-fork-bench\) fork: \d+ cycles per fork of \d+ dirty pages$/,
+	       @output);
+
+pass;
@@ -0,0 +1,62 @@
+/* Touches more anonymous memory than fits in the 10 MB machine, then
+   reads it all back, timing the first access to each page, and
+   reports latency percentiles of those page faults.  With pages
+   reclaimed in the background, most faults should only have to
+   read from swap, not also write a victim out first. */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_SIZE (20 * 1024 * 1024)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+static uint64_t lat[PAGE_COUNT];
+
+static inline uint64_t
+rdtsc (void)
+{
+	uint32_t lo, hi;
+	asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
+static int
+compare_u64 (const void *a_, const void *b_)
+{
+	const uint64_t *a = a_;
+	const uint64_t *b = b_;
+	return *a < *b ? -1 : *a > *b;
+}
+
+void
+test_main (void)
+{
+	size_t i;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		big_chunks[i * PAGE_SIZE] = (char) i;
+	msg ("wrote %d pages", PAGE_COUNT);
+
+	for (i = 0; i < PAGE_COUNT; i++) {
+		volatile char *mem = big_chunks + i * PAGE_SIZE;
+		uint64_t start = rdtsc ();
+		char c = *mem;
+
+		lat[i] = rdtsc () - start;
+		if (c != (char) i)
+			fail ("data is inconsistent in page %zu", i);
+	}
+	msg ("read back %d pages", PAGE_COUNT);
+
+	qsort (lat, PAGE_COUNT, sizeof *lat, compare_u64);
+	msg ("fault latency: p50 %llu, p90 %llu, p99 %llu cycles",
+	     (unsigned long long) lat[PAGE_COUNT / 2],
+	     (unsigned long long) lat[PAGE_COUNT * 9 / 10],
+	     (unsigned long long) lat[PAGE_COUNT * 99 / 100]);
+}
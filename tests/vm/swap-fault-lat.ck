@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "data is inconsistent"
+  if grep (/data is inconsistent/, @output);
+fail "missing fault latency in output"
+  unless grep (/^\(swap-fault-lat\) fault latency: p50 \d+, p90 \d+, p99 \d+ cycles$/,
+	       @output);
+
+pass;
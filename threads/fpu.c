@@ -0,0 +1,179 @@
+#include "threads/fpu.h"
+#include <debug.h>
+#include <round.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Lazy FPU switching.
+
+   The kernel is built with -msoft-float -mno-sse and never uses
+   the FPU itself, so FPU registers only ever hold user state.
+   Instead of saving and restoring them on every context switch,
+   we remember which thread's state is loaded (fpu_owner) and
+   leave CR0.TS set while anybody else runs.  The
+   first FPU or SSE instruction of such a thread raises #NM, and
+   only then is the owner's state saved and the new thread's
+   state loaded.  A thread that never touches the FPU is never
+   given a save area and costs nothing beyond keeping TS set. */
+
+#define CR0_MP 0x00000002       /* Monitor coprocessor. */
+#define CR0_EM 0x00000004       /* Emulate coprocessor. */
+#define CR0_TS 0x00000008       /* Task switched. */
+#define CR0_NE 0x00000020       /* Native x87 error reporting. */
+#define CR4_OSFXSR 0x00000200   /* FXSAVE/FXRSTOR and SSE enabled. */
+#define CR4_OSXMMEXCPT 0x00000400 /* Unmasked SSE exceptions raise #XF. */
+
+/* Initial FCW and MXCSR: all exceptions masked, round to nearest. */
+#define FCW_INIT 0x037f
+#define MXCSR_INIT 0x1f80
+
+/* Thread whose FPU state is in the registers, or NULL.  Accessed
+   with interrupts off. */
+static struct thread *fpu_owner;
+
+/* Is CR0.TS set?  Cached so that fpu_switch() can skip the CR0
+   write when it would not change anything. */
+static bool fpu_ts;
+
+/* Statistics. */
+static long long fpu_traps;     /* # of #NM exceptions handled. */
+static long long fpu_saves;     /* # of times an owner's state was saved. */
+
+static void fpu_trap (struct intr_frame *);
+
+/* Returns the 16-byte aligned FXSAVE area of T. */
+static void *
+fpu_area (struct thread *t) {
+	return (void *) ROUND_UP ((uintptr_t) t->fpu->buf, 16);
+}
+
+/* Enables the FPU and SSE with CR0.TS set, so that the first use
+   traps, and installs the #NM handler. */
+void
+fpu_init (void) {
+	lcr0 ((rcr0 () & ~CR0_EM) | CR0_MP | CR0_NE | CR0_TS);
+	lcr4 (rcr4 () | CR4_OSFXSR | CR4_OSXMMEXCPT);
+	fpu_owner = NULL;
+	fpu_ts = true;
+
+	intr_register_int (7, 0, INTR_OFF, fpu_trap,
+			"#NM Device Not Available Exception");
+}
+
+/* Called by schedule() before switching to NEXT, with interrupts
+   off.  Clears CR0.TS if NEXT's state is the one loaded and sets
+   it otherwise, writing CR0 only when TS actually changes. */
+void
+fpu_switch (struct thread *next) {
+	bool ts = next != fpu_owner;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (ts == fpu_ts)
+		return;
+	if (ts)
+		lcr0 (rcr0 () | CR0_TS);
+	else
+		clts ();
+	fpu_ts = ts;
+}
+
+/* Releases the current thread's FPU state, so that its next FPU
+   use starts from the initial state.  Called from thread_exit()
+   and when a process execs a new program. */
+void
+fpu_reset (void) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (fpu_owner == cur) {
+		/* Our registers stay loaded, so make the next use trap. */
+		fpu_owner = NULL;
+		lcr0 (rcr0 () | CR0_TS);
+		fpu_ts = true;
+	}
+	intr_set_level (old_level);
+
+	free (cur->fpu);
+	cur->fpu = NULL;
+}
+
+/* Gives CHILD, being forked from PARENT, a copy of PARENT's FPU
+   state, if PARENT has used the FPU.  Returns false if out of
+   memory. */
+bool
+fpu_fork (struct thread *child, struct thread *parent) {
+	enum intr_level old_level;
+
+	ASSERT (child->fpu == NULL);
+
+	if (parent->fpu == NULL)
+		return true;
+	child->fpu = malloc (sizeof *child->fpu);
+	if (child->fpu == NULL)
+		return false;
+
+	old_level = intr_disable ();
+	if (fpu_owner == parent) {
+		/* PARENT's registers are newer than its save area. */
+		clts ();
+		fxsave (fpu_area (parent));
+		if (fpu_ts)
+			lcr0 (rcr0 () | CR0_TS);
+		fpu_saves++;
+	}
+	memcpy (fpu_area (child), fpu_area (parent), 512);
+	intr_set_level (old_level);
+	return true;
+}
+
+/* #NM handler: the running thread used the FPU while CR0.TS was
+   set.  Saves the owner's registers, loads ours and clears TS. */
+static void
+fpu_trap (struct intr_frame *f) {
+	struct thread *cur = thread_current ();
+
+	if ((f->cs & 3) == 0)
+		PANIC ("Kernel used the FPU at %p", (void *) f->rip);
+
+	if (cur->fpu == NULL) {
+		/* First use: start from the state FNINIT would give.
+		   malloc() may sleep, so let the timer in meanwhile; we
+		   take CR0.TS into our own hands again below. */
+		intr_enable ();
+		cur->fpu = malloc (sizeof *cur->fpu);
+		if (cur->fpu == NULL) {
+			printf ("%s: out of memory for FPU state\n", thread_name ());
+			cur->proc->exit_status = -1;
+			thread_exit ();
+		}
+		memset (cur->fpu, 0, sizeof *cur->fpu);
+		*(uint16_t *) fpu_area (cur) = FCW_INIT;
+		*(uint32_t *) ((uint8_t *) fpu_area (cur) + 24) = MXCSR_INIT;
+		intr_disable ();
+	}
+
+	clts ();
+	fpu_ts = false;
+	fpu_traps++;
+	if (fpu_owner == cur)
+		return;
+
+	if (fpu_owner != NULL) {
+		fxsave (fpu_area (fpu_owner));
+		fpu_saves++;
+	}
+	fxrstor (fpu_area (cur));
+	fpu_owner = cur;
+}
+
+/* Prints FPU statistics. */
+void
+fpu_print_stats (void) {
+	printf ("FPU: %lld traps, %lld state saves\n", fpu_traps, fpu_saves);
+}
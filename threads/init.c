@@ -20,6 +20,8 @@
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/fpu.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -93,12 +95,14 @@ main (void) {
 #endif
 	/* Initialize interrupt handlers. */
 	intr_init ();
+	fpu_init ();
 	timer_init ();
 	kbd_init ();
 	input_init ();
 #ifdef USERPROG
 	exception_init ();
 	syscall_init ();
+	process_table_init ();
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start ();
@@ -220,11 +224,30 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp (name, "-ts")) {
+			int ticks = value != NULL ? atoi (value) : 0;
+			if (ticks <= 0)
+				PANIC ("-ts needs a positive number of ticks");
+			thread_time_slice = ticks;
+		}
+		else if (!strcmp (name, "-sched-trace"))
+			thread_trace = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp (name, "-vm-policy")) {
+			if (value == NULL || !vm_set_policy (value))
+				PANIC ("unknown page replacement policy `%s'",
+						value != NULL ? value : "");
+		}
+		else if (!strcmp (name, "-no-kswapd"))
+			vm_kswapd = false;
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -324,8 +347,16 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -tickless          Stop the periodic timer tick while idle.\n"
+			"  -ts=TICKS          Set the base time slice to TICKS ticks.\n"
+			"  -sched-trace       Dump scheduler trace and accounting at exit.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -vm-policy=NAME    Replace pages by NAME: clock (default),\n"
+			"                     clock-dirty or 2q.\n"
+			"  -no-kswapd         Reclaim frames only in the faulting thread.\n"
 #endif
 			);
 	power_off ();
@@ -352,6 +383,12 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	spin_lock_print_stats ();
+	fpu_print_stats ();
+	intr_print_stats ();
+#ifdef VM
+	vm_print_stats ();
+#endif
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
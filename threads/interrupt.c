@@ -13,6 +13,7 @@
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/process.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -107,6 +108,14 @@ static bool in_external_intr;   /* Are we processing an external interrupt? */
 // 인터럽트 반환을 양보해야 합니까?
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Per-vector latency statistics; see intr_stats_enter().  The
+   measurements in progress nest per thread, in the intr_slot and
+   intr_off_since members of struct thread, since a handler or a
+   system call may sleep while other threads run their own. */
+static struct intr_stats intr_stat_table[INTR_STAT_CNT];
+
+static void intr_stats_off_end (struct thread *, uint64_t now);
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -141,6 +150,9 @@ intr_enable (void) {
 	enum intr_level old_level = intr_get_level ();
 	ASSERT (!intr_context ());
 
+	if (old_level == INTR_OFF && thread_current ()->intr_off_since != 0)
+		intr_stats_off_end (thread_current (), rdtsc ());
+
 	/* Enable interrupts by setting the interrupt flag.
 
 	   See [IA32-v2b] "STI" and [IA32-v3a] 5.8.1 "Masking Maskable
@@ -336,6 +348,7 @@ void
 intr_handler (struct intr_frame *frame) {
 	bool external;
 	intr_handler_func *handler;
+	struct intr_stats_scope scope;
 
 	/* External interrupts are special.
 	   We only handle one at a time (so interrupts must be off)
@@ -350,6 +363,8 @@ intr_handler (struct intr_frame *frame) {
 		yield_on_return = false;
 	}
 
+	intr_stats_enter (&scope, frame->vec_no);
+
 	/* Invoke the interrupt's handler. */
 	handler = intr_handlers[frame->vec_no];
 	if (handler != NULL)
@@ -365,6 +380,10 @@ intr_handler (struct intr_frame *frame) {
 		PANIC ("Unexpected interrupt");
 	}
 
+	/* Before a yield, so that the next thread's time is not
+	   charged to this interrupt. */
+	intr_stats_exit (&scope);
+
 	/* Complete the processing of an external interrupt. */
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
@@ -376,6 +395,15 @@ intr_handler (struct intr_frame *frame) {
 		if (yield_on_return)
 			thread_yield ();
 	}
+
+#ifdef USERPROG
+	/* A thread whose process is exiting dies instead of going back
+	   to user mode; see process_exit_group(). */
+	if (frame->cs == SEL_UCSEG && process_dying ()) {
+		intr_enable ();
+		thread_exit ();
+	}
+#endif
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
@@ -407,3 +435,103 @@ const char *
 intr_name (uint8_t vec) {
 	return intr_names[vec];
 }
+
+/* Starts measuring a run of the handler for statistics slot SLOT
+   (an interrupt vector or INTR_STAT_SYSCALL), remembering in
+   SCOPE the measurement of the running thread it interrupts.  If
+   interrupts are off, the stretch until they are turned on, or
+   until the matching intr_stats_exit(), counts as interrupts-off
+   time for SLOT. */
+void
+intr_stats_enter (struct intr_stats_scope *scope, int slot) {
+	struct thread *t = thread_current ();
+
+	ASSERT (slot >= 0 && slot < INTR_STAT_CNT);
+
+	scope->slot = slot;
+	scope->start = rdtsc ();
+	scope->outer_slot = t->intr_slot;
+	scope->outer_off = t->intr_off_since;
+	t->intr_slot = slot;
+	t->intr_off_since = intr_get_level () == INTR_OFF ? scope->start : 0;
+}
+
+/* Ends the measurement started by intr_stats_enter() with SCOPE
+   and resumes the one it interrupted. */
+void
+intr_stats_exit (struct intr_stats_scope *scope) {
+	struct thread *t = thread_current ();
+	uint64_t now = rdtsc ();
+	struct intr_stats *s = &intr_stat_table[scope->slot];
+	uint64_t cycles = now - scope->start;
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (t->intr_slot == scope->slot);
+
+	if (t->intr_off_since != 0)
+		intr_stats_off_end (t, now);
+	s->count++;
+	s->cycles += cycles;
+	if (cycles > s->max_cycles)
+		s->max_cycles = cycles;
+
+	t->intr_slot = scope->outer_slot;
+	t->intr_off_since = scope->outer_off;
+	intr_set_level (old_level);
+}
+
+/* Drops the running thread's measurements in progress, without
+   counting them, for a thread that goes back to user mode without
+   returning through them, as exec() does. */
+void
+intr_stats_abandon (void) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	t->intr_slot = -1;
+	t->intr_off_since = 0;
+	intr_set_level (old_level);
+}
+
+/* Closes the interrupts-off stretch of the handler T is running
+   at time NOW. */
+static void
+intr_stats_off_end (struct thread *t, uint64_t now) {
+	struct intr_stats *s = &intr_stat_table[t->intr_slot];
+	uint64_t off = now - t->intr_off_since;
+
+	if (off > s->max_off_cycles)
+		s->max_off_cycles = off;
+	t->intr_off_since = 0;
+}
+
+/* Copies the statistics of slot SLOT into *STATS.  Returns false
+   if SLOT is out of range. */
+bool
+intr_get_stats (int slot, struct intr_stats *stats) {
+	enum intr_level old_level;
+
+	if (slot < 0 || slot >= INTR_STAT_CNT)
+		return false;
+	old_level = intr_disable ();
+	*stats = intr_stat_table[slot];
+	intr_set_level (old_level);
+	return true;
+}
+
+/* Prints the statistics of every slot that was ever taken. */
+void
+intr_print_stats (void) {
+	for (int i = 0; i < INTR_STAT_CNT; i++) {
+		struct intr_stats s;
+
+		intr_get_stats (i, &s);
+		if (s.count == 0)
+			continue;
+		printf ("Interrupt %#04x (%s): %"PRIu64" times, "
+				"%"PRIu64" avg / %"PRIu64" max cycles, "
+				"%"PRIu64" max cycles with interrupts off\n",
+				i, i == INTR_STAT_SYSCALL ? "syscall" : intr_names[i],
+				s.count, s.cycles / s.count, s.max_cycles, s.max_off_cycles);
+	}
+}
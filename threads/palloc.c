@@ -343,6 +343,34 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Returns the number of pages in the user pool, including any
+   that are never handed out. */
+size_t
+palloc_user_page_cnt (void) {
+	return bitmap_size (user_pool.used_map);
+}
+
+/* Returns the number of free pages in the user pool. */
+size_t
+palloc_user_free_cnt (void) {
+	size_t cnt;
+
+	lock_acquire (&user_pool.lock);
+	cnt = bitmap_count (user_pool.used_map, 0,
+			bitmap_size (user_pool.used_map), false);
+	lock_release (&user_pool.lock);
+	return cnt;
+}
+
+/* Returns the index of PAGE, which must come from the user pool,
+   within that pool.  Indexes run from 0 to
+   palloc_user_page_cnt() - 1. */
+size_t
+palloc_user_page_idx (const void *page) {
+	ASSERT (page_from_pool (&user_pool, (void *) page));
+	return pg_no (page) - pg_no (user_pool.base);
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
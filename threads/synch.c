@@ -31,27 +31,126 @@
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
-
-#define max(x, y) (x) > (y) ? (x) : (y)
+#include "intrinsic.h"
 
 static bool sema_priority(const struct list_elem *a_, const struct list_elem *b_,
             void *aux UNUSED);
 
-static bool lock_priority(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED);
+static bool sema_elem_less (const struct heap_elem *, const struct heap_elem *,
+            void *aux);
 
-static bool sema_elem_priority(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED);
+static bool waiter_less (const struct heap_elem *, const struct heap_elem *,
+            void *aux);
 
-/* 재귀형태로 구현한 함수 for nested & chain */
-void donate_recursion(struct thread *t){
-	if(t->priority > t->wait_on_lock->holder->priority)
-		t->wait_on_lock->holder->priority = t->priority;
-	
-	if(t->wait_on_lock->holder->wait_on_lock != NULL){
-		donate_recursion(t->wait_on_lock->holder);
+static void sema_wake_one (struct semaphore *);
+static void lock_acquire_slow (struct lock *);
+static void lock_release_slow (struct lock *);
+static void rwlock_sync_donation (struct rwlock *, int depth);
+
+/* Protects every lock's waiter heap, every thread's held_locks
+   heap and the priorities derived from them, so that a donation
+   can walk a chain of locks consistently.  A zeroed spinlock is
+   unlocked. */
+static struct spinlock donation_lock;
+
+/* Stamps waiters in arrival order, so that of several waiters with
+   the same priority the earliest is woken first. */
+static uint64_t next_waiter_seq;
+
+/* Returns the next arrival stamp for a waiter. */
+static inline uint64_t
+waiter_seq_next (void) {
+	return __atomic_fetch_add (&next_waiter_seq, 1, __ATOMIC_RELAXED);
+}
+
+/* Spinlock statistics, summed over every spinlock. */
+static uint64_t spin_acquisitions;  /* # of spin_lock() calls. */
+static uint64_t spin_contended;     /* # of those that had to spin. */
+static uint64_t spin_hold_cycles;   /* Total cycles locks were held. */
+static uint64_t spin_max_hold;      /* Longest single hold, in cycles. */
+
+/* Initializes spinlock LOCK as unlocked. */
+void
+spin_lock_init (struct spinlock *lock) {
+	ASSERT (lock != NULL);
+
+	lock->next = 0;
+	lock->owner = 0;
+	lock->holder = NULL;
+	lock->acquired_at = 0;
+}
+
+/* Acquires LOCK, spinning until it is available.  Interrupts are
+   left as they are, so the caller must already have them off if
+   LOCK is also taken from an interrupt handler. */
+void
+spin_lock (struct spinlock *lock) {
+	unsigned ticket;
+	bool contended = false;
+
+	ASSERT (lock != NULL);
+	ASSERT (lock->holder != thread_current ());
+
+	ticket = __atomic_fetch_add (&lock->next, 1, __ATOMIC_RELAXED);
+	while (__atomic_load_n (&lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+		contended = true;
+		asm volatile ("pause");
 	}
+	lock->holder = thread_current ();
+	lock->acquired_at = rdtsc ();
+
+	__atomic_fetch_add (&spin_acquisitions, 1, __ATOMIC_RELAXED);
+	if (contended)
+		__atomic_fetch_add (&spin_contended, 1, __ATOMIC_RELAXED);
+}
+
+/* Releases LOCK, which must be held by the running thread. */
+void
+spin_unlock (struct spinlock *lock) {
+	uint64_t held;
+
+	ASSERT (lock != NULL);
+	ASSERT (lock->holder == thread_current ());
+
+	held = rdtsc () - lock->acquired_at;
+	__atomic_fetch_add (&spin_hold_cycles, held, __ATOMIC_RELAXED);
+	if (held > spin_max_hold)
+		spin_max_hold = held;
+
+	lock->holder = NULL;
+	__atomic_store_n (&lock->owner, lock->owner + 1, __ATOMIC_RELEASE);
+}
+
+/* Disables interrupts, acquires LOCK and returns the previous
+   interrupt level for spin_unlock_irqrestore(). */
+enum intr_level
+spin_lock_irqsave (struct spinlock *lock) {
+	enum intr_level old_level = intr_disable ();
+
+	spin_lock (lock);
+	return old_level;
+}
+
+/* Releases LOCK and restores the interrupt level OLD_LEVEL
+   returned by spin_lock_irqsave(). */
+void
+spin_unlock_irqrestore (struct spinlock *lock, enum intr_level old_level) {
+	spin_unlock (lock);
+	intr_set_level (old_level);
+}
+
+/* Prints spinlock statistics. */
+void
+spin_lock_print_stats (void) {
+	printf ("Spinlock: %llu acquisitions, %llu contended, "
+			"%llu avg / %llu max cycles held\n",
+			(unsigned long long) spin_acquisitions,
+			(unsigned long long) spin_contended,
+			(unsigned long long) (spin_acquisitions
+				? spin_hold_cycles / spin_acquisitions : 0),
+			(unsigned long long) spin_max_hold);
 }
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -66,7 +165,8 @@ sema_init (struct semaphore *sema, unsigned value) {
 	ASSERT (sema != NULL);
 
 	sema->value = value;
-	list_init (&sema->waiters);
+	heap_init (&sema->waiters, waiter_less, NULL);
+	spin_lock_init (&sema->lock);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -83,15 +183,25 @@ sema_down (struct semaphore *sema) {
 	ASSERT (sema != NULL);
 	ASSERT (!intr_context ());
 
-	old_level = intr_disable ();
+	old_level = spin_lock_irqsave (&sema->lock);
 	while (sema->value == 0) {
-		// list_push_front (&sema->waiters, &thread_current ()->elem);
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, sema_priority, NULL);
+		struct thread *cur = thread_current ();
+
+		/* Kept in a heap, so that sema_up() finds the
+		   highest-priority waiter in O(1) and removes it in
+		   O(log n). */
+		cur->waiter_seq = waiter_seq_next ();
+		cur->wait_on_sema = sema;
+		heap_push (&sema->waiters, &cur->waiter_elem);
+		/* Interrupts stay off until we are blocked, so sema_up()
+		   cannot see us on WAITERS before we are THREAD_BLOCKED. */
+		spin_unlock (&sema->lock);
 		thread_block ();
+		spin_lock (&sema->lock);
 	}
 	thread_current()->has_lock += 1;
 	sema->value--;
-	intr_set_level (old_level);
+	spin_unlock_irqrestore (&sema->lock, old_level);
 }
 
 /* Down or "P" operation on a semaphore, but only if the
@@ -106,7 +216,7 @@ sema_try_down (struct semaphore *sema) {
 
 	ASSERT (sema != NULL);
 
-	old_level = intr_disable ();
+	old_level = spin_lock_irqsave (&sema->lock);
 	if (sema->value > 0)
 	{
 		sema->value--;
@@ -114,7 +224,7 @@ sema_try_down (struct semaphore *sema) {
 	}
 	else
 		success = false;
-	intr_set_level (old_level);
+	spin_unlock_irqrestore (&sema->lock, old_level);
 
 	return success;
 }
@@ -126,25 +236,51 @@ sema_try_down (struct semaphore *sema) {
 void
 sema_up (struct semaphore *sema) {
 	enum intr_level old_level;
-	struct thread *sema_top_priority; 
 	ASSERT (sema != NULL);
 
-	old_level = intr_disable ();
-	if (!list_empty (&sema->waiters))
-	{
-		list_sort(&sema->waiters, sema_priority, NULL);
-		sema_top_priority = list_entry(list_pop_front(&sema->waiters),
-					struct thread, elem);
-		thread_unblock (sema_top_priority);
-	}
+	old_level = spin_lock_irqsave (&sema->lock);
+	sema_wake_one (sema);
 	thread_current()->has_lock -= 1;
 	sema->value++;
-	intr_set_level (old_level);
+	spin_unlock_irqrestore (&sema->lock, old_level);
 
 	// thread_yield();
 	try_thread_yield();
 }
 
+/* Unblocks the highest-priority thread waiting on SEMA, if any.
+   SEMA's spinlock must be held. */
+static void
+sema_wake_one (struct semaphore *sema) {
+	struct heap_elem *e = heap_pop_max (&sema->waiters);
+
+	if (e != NULL)
+	{
+		struct thread *t = heap_entry (e, struct thread, waiter_elem);
+
+		t->wait_on_sema = NULL;
+		thread_unblock (t);
+	}
+}
+
+/* Re-sorts T, which sleeps on a semaphore, among that semaphore's
+   waiters after its priority changed.  Called by
+   thread_requeue() with interrupts off. */
+void
+sema_requeue (struct thread *t) {
+	struct semaphore *sema = t->wait_on_sema;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	spin_lock (&sema->lock);
+	/* It may have been woken while we took the lock. */
+	if (t->wait_on_sema == sema) {
+		heap_remove (&sema->waiters, &t->waiter_elem);
+		heap_push (&sema->waiters, &t->waiter_elem);
+	}
+	spin_unlock (&sema->lock);
+}
+
 static void sema_test_helper (void *sema_);
 
 /* Self-test for semaphores that makes control "ping-pong"
@@ -199,7 +335,155 @@ void
 lock_init (struct lock *lock) {
 	ASSERT (lock != NULL);
 	lock->holder = NULL;
-	sema_init (&lock->semaphore, 1);
+	lock->state = LOCK_FREE;
+	heap_init (&lock->waiters, waiter_less, NULL);
+	lock->donee = NULL;
+	lock->lock_priority = PRI_MIN - 1;
+}
+
+/* Atomically changes LOCK's state from OLD to NEW.  Returns true
+   if it was OLD. */
+static inline bool
+lock_cas (struct lock *lock, int old, int new) {
+	return __atomic_compare_exchange_n (&lock->state, &old, new, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/* Returns the priority LOCK donates: that of its highest-priority
+   waiter, or PRI_MIN - 1 if nobody waits for it. */
+static int
+lock_top_priority (struct lock *lock) {
+	struct heap_elem *e = heap_max (&lock->waiters);
+
+	if (e == NULL)
+		return PRI_MIN - 1;
+	return heap_entry (e, struct thread, waiter_elem)->priority;
+}
+
+/* Brings LOCK's entry in its holder's held_locks heap up to date
+   with LOCK's waiters.  A lock is in its holder's heap only while
+   somebody waits for it.  donation_lock must be held. */
+static void
+lock_sync_donation (struct lock *lock) {
+	if (lock->donee != NULL)
+		heap_remove (&lock->donee->held_locks, &lock->held_elem);
+	lock->lock_priority = lock_top_priority (lock);
+	lock->donee = heap_empty (&lock->waiters) ? NULL : lock->holder;
+	if (lock->donee != NULL)
+		heap_push (&lock->donee->held_locks, &lock->held_elem);
+}
+
+/* Recomputes T's effective priority as the larger of its base
+   priority and the priority donated by the locks and rwlocks it
+   holds.  Returns true if it changed.  donation_lock must be
+   held. */
+static bool
+donation_refresh (struct thread *t) {
+	struct heap_elem *e = heap_max (&t->held_locks);
+	int priority = t->original_priority;
+
+	if (thread_mlfqs)
+		return false;
+	if (e != NULL) {
+		int donated = heap_entry (e, struct lock, held_elem)->lock_priority;
+		if (donated > priority)
+			priority = donated;
+	}
+	e = heap_max (&t->held_rwlocks);
+	if (e != NULL) {
+		int donated = heap_entry (e, struct rwlock_hold, held_elem)->priority;
+		if (donated > priority)
+			priority = donated;
+	}
+	if (priority == t->priority)
+		return false;
+
+	t->priority = priority;
+	/* donation_propagate() re-sorts a lock waiter itself, with
+	   donation_lock held, which thread_requeue() must not be. */
+	if (t->wait_on_lock == NULL)
+		thread_requeue (t);
+	return true;
+}
+
+/* Passes a change in T's priority along the chain of locks T
+   waits for: T is re-sorted among its lock's waiters, the lock's
+   donation to its holder is updated, and so on for the holder,
+   stopping after DONATION_DEPTH_MAX locks or as soon as a
+   holder's priority does not change.  An rwlock in the chain
+   donates to each of its holders, and the chain goes on from
+   every one whose priority changed.  DEPTH is the number of locks
+   already passed.  donation_lock must be held. */
+static void
+donation_propagate (struct thread *t, int depth) {
+	for (; depth < DONATION_DEPTH_MAX; depth++) {
+		struct lock *lock = t->wait_on_lock;
+
+		if (t->wait_on_rwlock != NULL) {
+			rwlock_sync_donation (t->wait_on_rwlock, depth + 1);
+			return;
+		}
+		if (lock == NULL)
+			return;
+		heap_remove (&lock->waiters, &t->waiter_elem);
+		heap_push (&lock->waiters, &t->waiter_elem);
+		lock_sync_donation (lock);
+
+		t = lock->holder;
+		if (t == NULL || !donation_refresh (t))
+			return;
+	}
+}
+
+/* Re-sorts T, which waits for a lock, among that lock's waiters
+   after its priority was changed other than by donation, as the
+   MLFQS does.  Called by thread_requeue() with interrupts off. */
+void
+lock_requeue (struct thread *t) {
+	struct lock *lock;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	spin_lock (&donation_lock);
+	lock = t->wait_on_lock;
+	/* It may have been woken while we took the lock. */
+	if (lock != NULL) {
+		heap_remove (&lock->waiters, &t->waiter_elem);
+		heap_push (&lock->waiters, &t->waiter_elem);
+		lock_sync_donation (lock);
+	}
+	spin_unlock (&donation_lock);
+}
+
+/* Recomputes T's priority after its base priority changed and
+   passes the change on to the locks T waits for. */
+void
+donation_update (struct thread *t) {
+	enum intr_level old_level;
+
+	old_level = spin_lock_irqsave (&donation_lock);
+	if (donation_refresh (t))
+		donation_propagate (t, 0);
+	spin_unlock_irqrestore (&donation_lock, old_level);
+}
+
+/* Records the current thread as the holder of LOCK, just taken
+   on the fast path.  A waiter that arrived before the holder was
+   set could not donate to us, so settle its donation now. */
+static void
+lock_fast_acquired (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level;
+
+	__atomic_store_n (&lock->holder, cur, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&lock->state, __ATOMIC_SEQ_CST) != LOCK_CONTENDED)
+		return;
+
+	old_level = spin_lock_irqsave (&donation_lock);
+	lock_sync_donation (lock);
+	if (donation_refresh (cur))
+		donation_propagate (cur, 0);
+	spin_unlock_irqrestore (&donation_lock, old_level);
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -216,26 +500,45 @@ lock_acquire (struct lock *lock) {
 	ASSERT (!intr_context ());
 	ASSERT (!lock_held_by_current_thread (lock));
 
-	struct thread *lock_holder;
-	struct thread *now = thread_current();
-
-	if (lock->holder != NULL)
-	{
-		lock_holder = lock->holder;
-		now->wait_on_lock = lock;
-		/* check 2 */
-		if (now->priority> lock_holder->priority)
-		{
-			list_insert_ordered(&lock_holder->donors, &now->donor_elem, lock_priority, NULL);
-			donate_recursion(now);
-					// now->wait_on_lock->holder->priority = now->priority;
-		}
+	/* Fast path: an uncontended lock is taken with one CAS and
+	   never touches the waiter heap or the donation machinery. */
+	if (lock_cas (lock, LOCK_FREE, LOCK_HELD)) {
+		lock_fast_acquired (lock);
+		return;
 	}
+	lock_acquire_slow (lock);
+}
 
+/* Slow path of lock_acquire(): joins LOCK's waiter heap, donates
+   our priority to the holder and sleeps until the lock is ours. */
+static void
+lock_acquire_slow (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level;
 
-	sema_down (&lock->semaphore);
-	thread_current()->wait_on_lock = NULL;
-	lock->holder = thread_current ();
+	old_level = spin_lock_irqsave (&donation_lock);
+
+	/* Marking the lock contended makes the holder's
+	   lock_release() take the slow path and wake us. */
+	while (__atomic_exchange_n (&lock->state, LOCK_CONTENDED, __ATOMIC_ACQUIRE)
+			!= LOCK_FREE) {
+		cur->wait_on_lock = lock;
+		cur->waiter_seq = waiter_seq_next ();
+		heap_push (&lock->waiters, &cur->waiter_elem);
+		lock_sync_donation (lock);
+		if (lock->holder != NULL && donation_refresh (lock->holder))
+			donation_propagate (lock->holder, 0);
+
+		spin_unlock (&donation_lock);
+		thread_block ();
+		spin_lock (&donation_lock);
+	}
+
+	/* Whoever still waits now donates to us. */
+	lock->holder = cur;
+	lock_sync_donation (lock);
+	donation_refresh (cur);
+	spin_unlock_irqrestore (&donation_lock, old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -251,9 +554,9 @@ lock_try_acquire (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (!lock_held_by_current_thread (lock));
 
-	success = sema_try_down (&lock->semaphore);
+	success = lock_cas (lock, LOCK_FREE, LOCK_HELD);
 	if (success)
-		lock->holder = thread_current ();
+		lock_fast_acquired (lock);
 	return success;
 }
 
@@ -268,39 +571,42 @@ lock_release (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (lock_held_by_current_thread (lock));
 
-	if (!list_empty(&lock->holder->donors)){
-
-		struct list_elem *element;
-		element = list_front(&lock->holder->donors);
-		
-		while(element != NULL){	
-			struct thread *t = list_entry(element, struct thread, donor_elem);
-			if (t->wait_on_lock == lock){
-				// list_sort(&thread_current()->donors, lock_priority, NULL);
-				list_remove(element);
-			}
-
-			element = element->next;
-			if (element->next == NULL){
-				break;
-			}
-		}
-	} 
-	
-	if (!list_empty(&thread_current()->donors))
-	{
-		struct thread* foremost_thread = list_entry(list_front(&thread_current()->donors), struct thread, donor_elem);
-		thread_current()->priority = foremost_thread->priority;
-	}
-	else {
-		thread_current()->priority = thread_current()->original_priority;
-	}
-
 	lock->holder = NULL;
-	thread_current()->wait_on_lock = NULL;
-	sema_up (&lock->semaphore);
 
+	/* Fast path: nobody marked the lock contended, so nobody
+	   waits and nobody donated through it. */
+	int held = LOCK_HELD;
+	if (__atomic_compare_exchange_n (&lock->state, &held, LOCK_FREE, false,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		return;
+	lock_release_slow (lock);
+}
+
+/* Slow path of lock_release(): frees LOCK, drops the priority it
+   donated to us and wakes its highest-priority waiter, which then
+   retries the acquire. */
+static void
+lock_release_slow (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	struct heap_elem *e;
+	enum intr_level old_level;
+
+	old_level = spin_lock_irqsave (&donation_lock);
+	__atomic_store_n (&lock->state, LOCK_FREE, __ATOMIC_RELEASE);
+	e = heap_pop_max (&lock->waiters);
+	lock_sync_donation (lock);
+	if (e != NULL) {
+		struct thread *t = heap_entry (e, struct thread, waiter_elem);
+
+		t->wait_on_lock = NULL;
+		thread_unblock (t);
+	}
+	donation_refresh (cur);
+	spin_unlock_irqrestore (&donation_lock, old_level);
+
+	try_thread_yield ();
 }
+
 /* Returns true if the current thread holds LOCK, false
    otherwise.  (Note that testing whether some other thread holds
    a lock would be racy.) */
@@ -311,11 +617,233 @@ lock_held_by_current_thread (const struct lock *lock) {
 	return lock->holder == thread_current ();
 }
  
-/* One semaphore in a list. */
+/* Initializes RW as unlocked. */
+void
+rwlock_init (struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	spin_lock_init (&rw->lock);
+	memset (&rw->writer, 0, sizeof rw->writer);
+	memset (rw->readers, 0, sizeof rw->readers);
+	rw->reader_cnt = 0;
+	rw->donation = PRI_MIN - 1;
+	list_init (&rw->read_waiters);
+	list_init (&rw->write_waiters);
+}
+
+/* Returns the highest priority among RW's waiters, or PRI_MIN - 1
+   if there are none.  donation_lock must be held. */
+static int
+rwlock_top_priority (struct rwlock *rw) {
+	struct list *lists[] = { &rw->read_waiters, &rw->write_waiters };
+	int priority = PRI_MIN - 1;
+
+	for (size_t i = 0; i < sizeof lists / sizeof *lists; i++) {
+		struct list_elem *e;
+
+		for (e = list_begin (lists[i]); e != list_end (lists[i]);
+				e = list_next (e)) {
+			struct thread *t = list_entry (e, struct thread, elem);
+			if (t->priority > priority)
+				priority = t->priority;
+		}
+	}
+	return priority;
+}
+
+/* Makes HOLD donate PRIORITY to its holder, or nothing if
+   PRIORITY is below PRI_MIN, and passes a change in the holder's
+   priority along, DEPTH locks into a donation chain.
+   donation_lock must be held. */
+static void
+rwlock_hold_donate (struct rwlock_hold *hold, int priority, int depth) {
+	struct thread *t = hold->holder;
+
+	if (t == NULL)
+		return;
+	if (hold->donating)
+		heap_remove (&t->held_rwlocks, &hold->held_elem);
+	hold->priority = priority;
+	hold->donating = priority >= PRI_MIN;
+	if (hold->donating)
+		heap_push (&t->held_rwlocks, &hold->held_elem);
+	if (donation_refresh (t))
+		donation_propagate (t, depth);
+}
+
+/* Brings the donation of every hold on RW up to date with RW's
+   waiters, DEPTH locks into a donation chain.  Without waiters,
+   as is usual, there is nothing to do unless the holds still
+   donate.  donation_lock must be held.
+
+   RW's waiter lists and holders change only with both RW's
+   spinlock and donation_lock held, so that this can also be
+   reached from donation_propagate() with just the latter. */
+static void
+rwlock_sync_donation (struct rwlock *rw, int depth) {
+	int priority = rwlock_top_priority (rw);
+
+	if (priority < PRI_MIN && rw->donation < PRI_MIN)
+		return;
+	rw->donation = priority;
+
+	rwlock_hold_donate (&rw->writer, priority, depth);
+	for (int i = 0; i < RWLOCK_READERS; i++)
+		rwlock_hold_donate (&rw->readers[i], priority, depth);
+}
+
+/* Makes the current thread the holder of HOLD on RW, so that the
+   threads still waiting for RW donate to it as well.  RW's
+   spinlock must be held. */
+static void
+rwlock_hold_take (struct rwlock *rw, struct rwlock_hold *hold) {
+	spin_lock (&donation_lock);
+	hold->holder = thread_current ();
+	rwlock_sync_donation (rw, 0);
+	spin_unlock (&donation_lock);
+}
+
+/* Gives up HOLD, which the current thread owns, dropping the
+   priority it donated.  The rwlock's spinlock must be held. */
+static void
+rwlock_hold_release (struct rwlock_hold *hold) {
+	ASSERT (hold->holder == thread_current ());
+
+	spin_lock (&donation_lock);
+	if (hold->donating)
+		rwlock_hold_donate (hold, PRI_MIN - 1, 0);
+	hold->holder = NULL;
+	spin_unlock (&donation_lock);
+}
+
+/* Adds the current thread to RW's waiters in LIST and sleeps.
+   RW's spinlock must be held with interrupts off; it is held
+   again on return. */
+static void
+rwlock_wait (struct rwlock *rw, struct list *list) {
+	struct thread *cur = thread_current ();
+
+	spin_lock (&donation_lock);
+	list_push_back (list, &cur->elem);
+	cur->wait_on_rwlock = rw;
+	rwlock_sync_donation (rw, 0);
+	spin_unlock (&donation_lock);
+
+	spin_unlock (&rw->lock);
+	thread_block ();
+	spin_lock (&rw->lock);
+}
+
+/* Takes T off RW's waiters and wakes it.  donation_lock must be
+   held. */
+static void
+rwlock_wake_one (struct thread *t) {
+	list_remove (&t->elem);
+	t->wait_on_rwlock = NULL;
+	thread_unblock (t);
+}
+
+/* Wakes the highest-priority writer waiting on RW if there is
+   one, otherwise every waiting reader.  RW's spinlock must be
+   held. */
+static void
+rwlock_wake (struct rwlock *rw) {
+	spin_lock (&donation_lock);
+	if (!list_empty (&rw->write_waiters))
+		rwlock_wake_one (list_entry (list_min (&rw->write_waiters,
+						sema_priority, NULL), struct thread, elem));
+	else
+		while (!list_empty (&rw->read_waiters))
+			rwlock_wake_one (list_entry (list_front (&rw->read_waiters),
+						struct thread, elem));
+	rwlock_sync_donation (rw, 0);
+	spin_unlock (&donation_lock);
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   waits for it, or while all reader slots are taken. */
+void
+rwlock_acquire_read (struct rwlock *rw) {
+	enum intr_level old_level;
+	int i;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	old_level = spin_lock_irqsave (&rw->lock);
+	while (rw->writer.holder != NULL || !list_empty (&rw->write_waiters)
+			|| rw->reader_cnt == RWLOCK_READERS)
+		rwlock_wait (rw, &rw->read_waiters);
+
+	for (i = 0; rw->readers[i].holder != NULL; i++)
+		continue;
+	rw->reader_cnt++;
+	/* Whoever still waits now donates to us as well. */
+	rwlock_hold_take (rw, &rw->readers[i]);
+	spin_unlock_irqrestore (&rw->lock, old_level);
+}
+
+/* Releases RW, which the current thread must hold for reading. */
+void
+rwlock_release_read (struct rwlock *rw) {
+	enum intr_level old_level;
+	int i;
+
+	ASSERT (rw != NULL);
+
+	old_level = spin_lock_irqsave (&rw->lock);
+	for (i = 0; rw->readers[i].holder != thread_current (); i++)
+		ASSERT (i + 1 < RWLOCK_READERS);
+	rwlock_hold_release (&rw->readers[i]);
+	rw->reader_cnt--;
+	/* The last reader lets a writer in; otherwise the freed slot
+	   goes to waiting readers unless a writer is queued. */
+	if (rw->reader_cnt == 0 || list_empty (&rw->write_waiters))
+		rwlock_wake (rw);
+	spin_unlock_irqrestore (&rw->lock, old_level);
+
+	try_thread_yield ();
+}
+
+/* Acquires RW for writing, sleeping until no reader or writer
+   holds it. */
+void
+rwlock_acquire_write (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (rw->writer.holder != thread_current ());
+
+	old_level = spin_lock_irqsave (&rw->lock);
+	while (rw->writer.holder != NULL || rw->reader_cnt > 0)
+		rwlock_wait (rw, &rw->write_waiters);
+	rwlock_hold_take (rw, &rw->writer);
+	spin_unlock_irqrestore (&rw->lock, old_level);
+}
+
+/* Releases RW, which the current thread must hold for writing. */
+void
+rwlock_release_write (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (rw->writer.holder == thread_current ());
+
+	old_level = spin_lock_irqsave (&rw->lock);
+	rwlock_hold_release (&rw->writer);
+	rwlock_wake (rw);
+	spin_unlock_irqrestore (&rw->lock, old_level);
+
+	try_thread_yield ();
+}
+
+/* One semaphore in a condition variable's waiters. */
 struct semaphore_elem {
-	struct list_elem elem;              /* List element. */
+	struct heap_elem elem;              /* Heap element. */
 	struct semaphore semaphore;         /* This semaphore. */
-	int sema_priority;
+	int sema_priority;                  /* Waiter's priority at cond_wait(). */
+	uint64_t seq;                       /* Arrival order. */
 };
 
 /* Initializes condition variable COND.  A condition variable
@@ -325,7 +853,7 @@ void
 cond_init (struct condition *cond) {
 	ASSERT (cond != NULL);
 
-	list_init (&cond->waiters);
+	heap_init (&cond->waiters, sema_elem_less, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -351,7 +879,6 @@ cond_init (struct condition *cond) {
 void
 cond_wait (struct condition *cond, struct lock *lock) {
 	struct semaphore_elem waiter;
-	waiter.sema_priority = NULL;
 
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
@@ -361,8 +888,8 @@ cond_wait (struct condition *cond, struct lock *lock) {
 	sema_init (&waiter.semaphore, 0);
 	
 	waiter.sema_priority = thread_current()->priority;
-	// list_push_back (&cond->waiters, &waiter.elem);
-	list_insert_ordered (&cond->waiters, &waiter.elem, sema_elem_priority, NULL);
+	waiter.seq = waiter_seq_next ();
+	heap_push (&cond->waiters, &waiter.elem);
 	lock_release (lock);
 	sema_down (&waiter.semaphore);
 	lock_acquire (lock);
@@ -383,9 +910,8 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED) {
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	if (!list_empty (&cond->waiters))
-		// list_sort(&cond->waiters, sema_priority, NULL);
-		sema_up (&list_entry (list_pop_front (&cond->waiters),
+	if (!heap_empty (&cond->waiters))
+		sema_up (&heap_entry (heap_pop_max (&cond->waiters),
 					struct semaphore_elem, elem)->semaphore);
 }
 
@@ -400,7 +926,7 @@ cond_broadcast (struct condition *cond, struct lock *lock) {
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 
-	while (!list_empty (&cond->waiters))
+	while (!heap_empty (&cond->waiters))
 		cond_signal (cond, lock);
 }
 
@@ -414,18 +940,50 @@ static bool sema_priority(const struct list_elem *a_, const struct list_elem *b_
 	return a->priority > b->priority;
 }
 
-static bool lock_priority(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED){
-	const struct thread *a = list_entry (a_, struct thread, elem);
-	const struct thread *b = list_entry (b_, struct thread, elem);
+/* Orders the waiters of a lock or semaphore by priority, and
+   waiters of equal priority by arrival so that the earliest is the
+   maximum. */
+static bool
+waiter_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, waiter_elem);
+	const struct thread *b = heap_entry (b_, struct thread, waiter_elem);
+
+	if (a->priority != b->priority)
+		return a->priority < b->priority;
+	return a->waiter_seq > b->waiter_seq;
+}
 
-	return a->priority > b->priority;
+/* Orders the locks a thread holds by the priority they donate. */
+bool
+lock_priority_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) {
+	const struct lock *a = heap_entry (a_, struct lock, held_elem);
+	const struct lock *b = heap_entry (b_, struct lock, held_elem);
+
+	return a->lock_priority < b->lock_priority;
 }
 
-static bool sema_elem_priority(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED){
-	struct semaphore_elem *a = list_entry (a_, struct semaphore_elem, elem);
-	struct semaphore_elem *b = list_entry (b_, struct semaphore_elem, elem);
+/* Orders the rwlock holds of a thread by the priority they
+   donate. */
+bool
+rwlock_hold_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) {
+	const struct rwlock_hold *a = heap_entry (a_, struct rwlock_hold, held_elem);
+	const struct rwlock_hold *b = heap_entry (b_, struct rwlock_hold, held_elem);
+
+	return a->priority < b->priority;
+}
 
-	return (a->sema_priority > b->sema_priority);
+/* Orders the waiters of a condition variable like waiter_less(),
+   by their priority when they started waiting. */
+static bool
+sema_elem_less (const struct heap_elem *a_, const struct heap_elem *b_,
+            void *aux UNUSED) {
+	const struct semaphore_elem *a = heap_entry (a_, struct semaphore_elem, elem);
+	const struct semaphore_elem *b = heap_entry (b_, struct semaphore_elem, elem);
+
+	if (a->sema_priority != b->sema_priority)
+		return a->sema_priority < b->sema_priority;
+	return a->seq > b->seq;
 }
\ No newline at end of file
@@ -5,8 +5,10 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -47,15 +49,47 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-struct list ready_list;
-static struct list sleep_list;
+/* Run queue of processes in THREAD_READY state, that is,
+   processes that are ready to run but not actually running.
+   There is one FIFO list per priority, and bit P of ready_bitmap
+   is set iff ready_queues[P] is non-empty, so the highest ready
+   priority is a single find-first-set.  Ready EDF threads are kept
+   apart in edf_queue. */
+static struct list ready_queues[PRI_MAX + 1];
+static struct heap edf_queue;
+static uint64_t ready_bitmap;
+static size_t ready_cnt;        /* # of threads in both queues. */
 struct list all_list;
 
+/* Hierarchical timing wheel of sleeping threads, keyed on
+   sleep_ticks.  The root wheel has one slot per tick for the next
+   WHEEL_ROOT_SIZE ticks; each upper level covers WHEEL_LVL_SIZE
+   times the span of the level below it.  Inserting a sleeper is
+   O(1), and a tick only touches the threads that wake on it plus,
+   once every WHEEL_ROOT_SIZE ticks, one slot cascaded down from
+   each upper level.  See sleep_wheel_add() for the slot mapping. */
+#define WHEEL_ROOT_BITS 8
+#define WHEEL_LVL_BITS 6
+#define WHEEL_LEVELS 3          /* # of levels above the root wheel. */
+#define WHEEL_ROOT_SIZE (1 << WHEEL_ROOT_BITS)
+#define WHEEL_LVL_SIZE (1 << WHEEL_LVL_BITS)
+#define WHEEL_ROOT_MASK (WHEEL_ROOT_SIZE - 1)
+#define WHEEL_LVL_MASK (WHEEL_LVL_SIZE - 1)
+#define WHEEL_SHIFT(lvl) (WHEEL_ROOT_BITS + (lvl) * WHEEL_LVL_BITS)
+#define WHEEL_SPAN ((int64_t) 1 << WHEEL_SHIFT (WHEEL_LEVELS))
+
+static struct list wheel_root[WHEEL_ROOT_SIZE];
+static struct list wheel_lvl[WHEEL_LEVELS][WHEEL_LVL_SIZE];
+static int64_t wheel_ticks;     /* Next tick the wheel will process. */
+
 /* load avg */
 static int64_t load_avg;
 
+/* Threads whose recent_cpu changed since their priority was last
+   recalculated, linked through mlfqs_elem.  calculate_all_priority()
+   only visits these instead of the whole all_list. */
+static struct list mlfqs_dirty;
+
 
 /* Idle thread. */
 static struct thread *idle_thread;
@@ -69,15 +103,74 @@ static struct lock tid_lock;
 /* Thread destruction requests */
 static struct list destruction_req;
 
+/* Pages of dead threads kept for reuse by thread_create(), linked
+   through the elem of the dead struct thread.  A hit skips the
+   palloc bitmap scan and only the struct thread header is zeroed,
+   not the whole page.  At most THREAD_POOL_MAX pages are kept;
+   on a miss the pool is refilled up to THREAD_POOL_LOW pages with
+   a single palloc_get_multiple() call.  Accessed with interrupts
+   off. */
+#define THREAD_POOL_MAX 32
+#define THREAD_POOL_LOW 8
+static struct list thread_pool;
+static size_t thread_pool_cnt;
+static long long thread_pool_hits;    /* # of pages reused from the pool. */
+static long long thread_pool_misses;  /* # of pages taken from palloc. */
+
 /* Statistics. */
 static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
+#define TIME_SLICE 4            /* Default base time slice, in ticks. */
+unsigned thread_time_slice = TIME_SLICE;
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
+/* schedule() and next_thread_to_run() should only need the first
+   cache line of a struct thread, besides the saved registers. */
+#define CACHE_LINE 64
+_Static_assert (offsetof (struct thread, tf) <= CACHE_LINE,
+		"hot fields of struct thread must fit in one cache line");
+
+/* Process bookkeeping of the initial thread, which starts before
+   malloc() is available. */
+static struct process initial_process;
+
+/* Scheduler trace: the last SCHED_TRACE_SIZE context switches,
+   written by schedule() on any CPU without taking a lock.  A
+   writer claims a slot by bumping sched_trace_head, clears the
+   slot's sequence number, fills it in and then publishes it by
+   storing the claimed index plus one as the sequence number.  A
+   reader accepts a slot only if it sees the expected sequence
+   number both before and after copying it, so a slot that was
+   being overwritten is skipped instead of printed torn. */
+#define SCHED_TRACE_SIZE 256    /* Must be a power of 2. */
+struct sched_event
+{
+	uint64_t seq;               /* Index of the event plus 1, or 0. */
+	uint64_t tsc;               /* Timestamp, in TSC cycles. */
+	tid_t prev;                 /* Thread switched away from. */
+	tid_t next;                 /* Thread switched to. */
+	enum sched_reason reason;   /* Why PREV stopped running. */
+};
+static struct sched_event sched_trace[SCHED_TRACE_SIZE];
+static uint64_t sched_trace_head;
+
+/* Sum of dl_util over all admitted EDF threads, per mille.
+   Accessed with interrupts off. */
+static int edf_util;
+
+/* EDF threads that ran out of budget.  They are scheduled as
+   ordinary threads at their own priority until dl_release, when
+   thread_tick() puts them back in the EDF class.  Accessed with
+   interrupts off. */
+static struct list edf_throttled;
+
+/* Dump the scheduler trace along with the other statistics?
+   Controlled by kernel command-line option "-sched-trace". */
+bool thread_trace;
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
@@ -87,21 +180,41 @@ static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
 static struct thread *next_thread_to_run (void);
-static void init_thread (struct thread *, const char *name, int priority);
+static void init_thread (struct thread *, const char *name, int priority,
+		struct process *);
 static void do_schedule(int status);
 static void schedule (void);
-static bool sleep_list_order(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED);
+static void sleep_wheel_add (struct thread *);
+static void sleep_wheel_cascade (int lvl, int idx);
 bool priority_scheduling(const struct list_elem *a_, const struct list_elem *b_,
             void *aux UNUSED);
 static bool advanced_scheduling(const struct list_elem *a_, const struct list_elem *b_,
             void *aux UNUSED);
-void apply_to_all();
+static void mark_mlfqs_dirty (struct thread *);
+static void update_time_slice (struct thread *);
+static struct thread *thread_page_get (void);
+static void sched_trace_record (uint64_t tsc, struct thread *prev,
+		struct thread *next, enum sched_reason);
+static void sched_account (uint64_t now, struct thread *prev,
+		struct thread *next);
+static void thread_page_put (struct thread *);
 static tid_t allocate_tid (void);
+static void ready_queue_push (struct thread *);
+static void ready_queue_remove (struct thread *);
+static struct thread *ready_queue_pop (void);
+static int ready_queue_max_priority (void);
+static bool ready_queue_outranks (struct thread *);
+static void edf_replenish (void);
+static void edf_unthrottle (struct thread *);
+static bool edf_later (const struct heap_elem *, const struct heap_elem *,
+		void *aux);
 void thread_sleep(ticks);
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
 
+/* Is T scheduled by deadline?  A throttled EDF thread is not. */
+#define edf_class(t) ((t)->dl_period != 0 && !(t)->dl_throttled)
+
 /* Returns the running thread.
  * Read the CPU's stack pointer `rsp', and then round that
  * down to the start of a page.  Since `struct thread' is
@@ -143,18 +256,32 @@ thread_init (void) {
 
 	/* Init the globla thread context */
 	lock_init (&tid_lock);
-	list_init (&ready_list);
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init (&ready_queues[i]);
+	heap_init (&edf_queue, edf_later, NULL);
+	ready_bitmap = 0;
+	ready_cnt = 0;
 	list_init (&destruction_req);
-	list_init (&sleep_list);
+	list_init (&thread_pool);
+	thread_pool_cnt = 0;
+	for (int i = 0; i < WHEEL_ROOT_SIZE; i++)
+		list_init (&wheel_root[i]);
+	for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++)
+		for (int i = 0; i < WHEEL_LVL_SIZE; i++)
+			list_init (&wheel_lvl[lvl][i]);
+	wheel_ticks = 0;
 	list_init (&all_list);
+	list_init (&mlfqs_dirty);
+	list_init (&edf_throttled);
 
 	load_avg = 0;
 	
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread ();
-	init_thread (initial_thread, "main", PRI_DEFAULT);
+	init_thread (initial_thread, "main", PRI_DEFAULT, &initial_process);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid ();
+	initial_thread->acct_stamp = rdtsc ();
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
@@ -192,16 +319,238 @@ thread_tick (void) {
 	else
 		kernel_ticks++;
 
+	/* An EDF thread that used up its budget is throttled until its
+	   current deadline, when it gets a fresh budget and the next
+	   deadline (as in CBS), so that an overrunning job can starve
+	   neither the other EDF threads nor the ordinary ones. */
+	if (edf_class (t) && --t->dl_budget <= 0) {
+		t->dl_throttled = true;
+		t->dl_release = t->dl_deadline;
+		t->dl_deadline += t->dl_period;
+		t->dl_budget = t->dl_runtime;
+		list_push_back (&edf_throttled, &t->dl_throttle_elem);
+		intr_yield_on_return ();
+	}
+	edf_replenish ();
+
 	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	if (++thread_ticks >= t->time_slice)
 		intr_yield_on_return ();
 }
 
+/* Puts the throttled EDF threads whose next period has started
+   back in the EDF class. */
+static void
+edf_replenish (void) {
+	int64_t now = timer_ticks ();
+	struct list_elem *e = list_begin (&edf_throttled);
+
+	while (e != list_end (&edf_throttled)) {
+		struct thread *t = list_entry (e, struct thread, dl_throttle_elem);
+
+		e = list_next (e);
+		if (t->dl_release > now)
+			continue;
+		list_remove (&t->dl_throttle_elem);
+		if (t->status == THREAD_READY) {
+			ready_queue_remove (t);
+			t->dl_throttled = false;
+			ready_queue_push (t);
+			if (ready_queue_outranks (thread_current ()))
+				intr_yield_on_return ();
+		} else
+			t->dl_throttled = false;
+	}
+}
+
+/* Takes the running thread off the throttled list, if it is on
+   it.  Interrupts must be off. */
+static void
+edf_unthrottle (struct thread *t) {
+	if (t->dl_throttled) {
+		list_remove (&t->dl_throttle_elem);
+		t->dl_throttled = false;
+	}
+}
+
+/* Credits TICKS timer ticks that passed while the idle thread was
+   halted with the periodic tick stopped (see timer_idle_enter()). */
+void
+thread_idle_catch_up (int64_t ticks) {
+	idle_ticks += ticks;
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) {
 	printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 			idle_ticks, kernel_ticks, user_ticks);
+	printf ("Thread pool: %lld hits, %lld misses, %zu pages cached\n",
+			thread_pool_hits, thread_pool_misses, thread_pool_cnt);
+	if (thread_trace)
+		thread_print_trace ();
+}
+
+/* One thread's CPU accounting, copied out by thread_print_trace(). */
+struct acct_snapshot {
+	tid_t tid;
+	char name[16];
+	uint64_t run, wait;
+	unsigned nvcsw, nivcsw;
+};
+
+/* Prints the CPU accounting of every live thread, then the
+   scheduler trace, oldest event first.  The accounting is copied
+   with interrupts off and printed with them on, since user
+   programs can call this through SYS_SCHED_TRACE. */
+void
+thread_print_trace (void) {
+	struct acct_snapshot *acct;
+	struct sched_event ev;
+	uint64_t head, first, base = 0, now;
+	size_t cnt, max;
+	enum intr_level old_level;
+	static const char *reasons[] = { "block", "yield", "exit" };
+
+	old_level = intr_disable ();
+	max = list_size (&all_list);
+	intr_set_level (old_level);
+	acct = malloc (max * sizeof *acct);
+
+	cnt = 0;
+	old_level = intr_disable ();
+	now = rdtsc ();
+	for (struct list_elem *e = list_begin (&all_list);
+			e != list_end (&all_list) && acct != NULL && cnt < max;
+			e = list_next (e)) {
+		struct thread *t = list_entry (e, struct thread, all_elem);
+		struct acct_snapshot *a = &acct[cnt++];
+
+		a->tid = t->tid;
+		strlcpy (a->name, t->name, sizeof a->name);
+		a->run = t->run_cycles;
+		a->wait = t->wait_cycles;
+		if (t->status == THREAD_RUNNING)
+			a->run += now - t->acct_stamp;
+		else if (t->status == THREAD_READY)
+			a->wait += now - t->acct_stamp;
+		a->nvcsw = t->nvcsw;
+		a->nivcsw = t->nivcsw;
+	}
+	intr_set_level (old_level);
+
+	printf ("Thread accounting (cycles):\n");
+	if (acct == NULL)
+		printf ("  (out of memory)\n");
+	for (size_t i = 0; i < cnt; i++)
+		printf ("  %5d %-16s run %llu, wait %llu, %u vol/%u invol switches\n",
+				acct[i].tid, acct[i].name, (unsigned long long) acct[i].run,
+				(unsigned long long) acct[i].wait, acct[i].nvcsw,
+				acct[i].nivcsw);
+	free (acct);
+
+	head = __atomic_load_n (&sched_trace_head, __ATOMIC_ACQUIRE);
+	first = head > SCHED_TRACE_SIZE ? head - SCHED_TRACE_SIZE : 0;
+	printf ("Scheduler trace (%llu of %llu switches, cycles since first):\n",
+			(unsigned long long) (head - first), (unsigned long long) head);
+	for (uint64_t i = first; i < head; i++) {
+		struct sched_event *slot = &sched_trace[i % SCHED_TRACE_SIZE];
+
+		if (__atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE) != i + 1)
+			continue;
+		ev = *slot;
+		__atomic_thread_fence (__ATOMIC_ACQUIRE);
+		if (__atomic_load_n (&slot->seq, __ATOMIC_RELAXED) != i + 1)
+			continue;
+		if (base == 0)
+			base = ev.tsc;
+		printf ("  %12llu %5d -> %-5d %s\n",
+				(unsigned long long) (ev.tsc - base), ev.prev, ev.next,
+				reasons[ev.reason]);
+	}
+}
+
+/* Appends a switch from PREV to NEXT at time TSC to the trace. */
+static void
+sched_trace_record (uint64_t tsc, struct thread *prev, struct thread *next,
+		enum sched_reason reason) {
+	uint64_t i = __atomic_fetch_add (&sched_trace_head, 1, __ATOMIC_RELAXED);
+	struct sched_event *slot = &sched_trace[i % SCHED_TRACE_SIZE];
+
+	__atomic_store_n (&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_RELEASE);
+	slot->tsc = tsc;
+	slot->prev = prev->tid;
+	slot->next = next->tid;
+	slot->reason = reason;
+	__atomic_store_n (&slot->seq, i + 1, __ATOMIC_RELEASE);
+}
+
+/* Charges the time since PREV's last stamp as running time and
+   the time NEXT spent on a run queue as waiting time, at time
+   NOW.  The idle thread never waits on a run queue. */
+static void
+sched_account (uint64_t now, struct thread *prev, struct thread *next) {
+	prev->run_cycles += now - prev->acct_stamp;
+	prev->acct_stamp = now;
+	if (prev->status == THREAD_READY)
+		prev->nivcsw++;
+	else
+		prev->nvcsw++;
+
+	if (next != idle_thread)
+		next->wait_cycles += now - next->acct_stamp;
+	next->acct_stamp = now;
+}
+
+/* Returns a page for a new thread, from the pool if possible.
+   Only init_thread() clears the page, and only its struct
+   thread part; the rest is stack.  Returns NULL if memory is
+   exhausted. */
+static struct thread *
+thread_page_get (void) {
+	struct thread *t = NULL;
+	uint8_t *pages;
+	size_t cnt;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (!list_empty (&thread_pool)) {
+		t = list_entry (list_pop_front (&thread_pool), struct thread, elem);
+		thread_pool_cnt--;
+		thread_pool_hits++;
+	} else
+		thread_pool_misses++;
+	intr_set_level (old_level);
+	if (t != NULL)
+		return t;
+
+	/* Miss: take the page we need plus enough to bring the pool
+	   back to its low-water mark in one bitmap scan.  Fall back to
+	   a single page when no such run of pages is free. */
+	cnt = THREAD_POOL_LOW + 1;
+	pages = palloc_get_multiple (0, cnt);
+	if (pages == NULL)
+		return palloc_get_page (0);
+
+	old_level = intr_disable ();
+	for (size_t i = 1; i < cnt; i++)
+		thread_page_put ((struct thread *) (pages + i * PGSIZE));
+	intr_set_level (old_level);
+	return (struct thread *) pages;
+}
+
+/* Returns the page of dead thread T to the pool, or to the page
+   allocator if the pool is full.  Interrupts must be off. */
+static void
+thread_page_put (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (thread_pool_cnt < THREAD_POOL_MAX) {
+		list_push_front (&thread_pool, &t->elem);
+		thread_pool_cnt++;
+	} else
+		palloc_free_page (t);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -223,22 +572,31 @@ tid_t
  thread_create (const char *name, int priority,
 		thread_func *function, void *aux) {
 	struct thread *t;
+	struct process *proc;
 	tid_t tid;
 
 	ASSERT (function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page (PAL_ZERO);
+	t = thread_page_get ();
 	if (t == NULL)
 		return TID_ERROR;
+	proc = malloc (sizeof *proc);
+	if (proc == NULL) {
+		enum intr_level old_level = intr_disable ();
+		thread_page_put (t);
+		intr_set_level (old_level);
+		return TID_ERROR;
+	}
 
 	/* Initialize thread. */
-	init_thread (t, name, priority);
+	init_thread (t, name, priority, proc);
 	tid = t->tid = allocate_tid ();
 
 	if (thread_mlfqs == true){
 		t->priority = calculate_advanced_priority(t);
 		t->original_priority = t->priority;
+		update_time_slice(t);
 	}
 
 	/* Call the kernel_thread if it scheduled.
@@ -254,7 +612,9 @@ tid_t
 
 
 	// t->tf.rsp = USER_STACK;
-  	list_push_back(&thread_current()->child_list, &t->child_list_elem);
+#ifdef USERPROG
+	process_register (t);
+#endif
 	/* Add to run queue. */
 	thread_unblock (t);
 	if (thread_get_priority() < priority)
@@ -296,10 +656,10 @@ thread_unblock (struct thread *t) {
 	old_level = intr_disable ();
 	ASSERT (t->status == THREAD_BLOCKED);
 
-	/* 쓰레드가 언블락되면 ready_list에 우선순위에 따라서 넣는 부분 */
-	list_insert_ordered(&ready_list, &t->elem, priority_scheduling, NULL);
-	//list_push_back (&ready_list, &t->elem);
+	/* 쓰레드가 언블락되면 우선순위에 해당하는 run queue에 넣는 부분 */
+	ready_queue_push (t);
 	t->status = THREAD_READY;
+	t->acct_stamp = rdtsc ();
 	intr_set_level (old_level);
 }
 
@@ -343,11 +703,21 @@ thread_exit (void) {
 	// sema_up(&thread_current()->parent->process_sema);
 	process_exit ();
 #endif
+	/* Our parent is done with our process bookkeeping once
+	   process_exit() returns. */
+	if (thread_current ()->proc != &initial_process)
+		free (thread_current ()->proc);
+	thread_current ()->proc = NULL;
+	fpu_reset ();
 
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable ();
-	// list_remove(&thread_current()->all_elem);
+	list_remove (&thread_current ()->all_elem);
+	if (thread_current ()->mlfqs_dirty)
+		list_remove (&thread_current ()->mlfqs_elem);
+	edf_util -= thread_current ()->dl_util;
+	edf_unthrottle (thread_current ());
 	do_schedule (THREAD_DYING);
 	NOT_REACHED ();
 }
@@ -364,10 +734,9 @@ thread_yield (void) {
 
 	old_level = intr_disable ();
 	if (curr != idle_thread){
-		// list_push_back (&ready_list, &curr->elem);
 		//우선순위 스케쥴링
-		/* yield를 할 때 현재 쓰레드를 ready_list에 우선순위에 따른 위치에 맞게 넣는 부분 */
-		list_insert_ordered(&ready_list, &curr->elem, priority_scheduling, NULL);
+		/* yield를 할 때 현재 쓰레드를 우선순위에 해당하는 run queue의 맨 뒤에 넣는 부분 */
+		ready_queue_push (curr);
 	}
 	do_schedule (THREAD_READY);
 	intr_set_level (old_level);
@@ -376,33 +745,118 @@ thread_yield (void) {
 /* Sets the current thread's priority to NEW_PRIORITY. */
 void
 thread_set_priority (int new_priority) {
-	/* priority-lower */
-	if (thread_current()->priority == thread_current()->original_priority){
-		thread_current ()->priority = new_priority;
-	} 
+	thread_current()->original_priority = new_priority;
 
-	if (thread_mlfqs == true){
+	/* priority-lower: 기부받은 우선순위가 더 높으면 그대로 유지 */
+	if (thread_mlfqs == true) {
 		thread_current()->priority = new_priority;
-	}
-	/* 이 줄의 추가로 priority-sema가 pass한다. 왜why?*/
-	/* 이 줄의 추가로 priority-fifo가 pass한다. 왜why?*/
-	thread_current()->original_priority = new_priority;
+		update_time_slice(thread_current());
+	} else
+		donation_update(thread_current());
 
 	//새 priority가 더 낮은지 확인
 	//Ready List에 더 높은 우선순위가 있다면 양보
-	struct list_elem *max_elem = list_max(&ready_list, priority_scheduling, NULL);
-	struct thread *next = list_entry(max_elem, struct thread, elem);
-	if (thread_get_priority() < next->priority){
+	if (thread_get_priority() < ready_queue_max_priority()){
 		thread_yield();	
 	}
 }
 
 void try_thread_yield(void){
-	if(!list_empty(&ready_list) && thread_current() != idle_thread )
-	{
-		if(thread_get_priority()<list_entry(list_begin(&ready_list),struct thread, elem)->priority)
-			thread_yield();
-	}	
+	if(thread_current() != idle_thread
+	   && thread_get_priority() < ready_queue_max_priority())
+		thread_yield();
+}
+
+/* Called after T's priority has been changed by someone other
+   than T itself (e.g. priority donation).  If T is on the run
+   queue, moves it to the queue that matches its new priority; if
+   it sleeps on a semaphore or waits for a lock, re-sorts it among
+   the waiters.  donation_lock must not be held. */
+void
+thread_requeue (struct thread *t) {
+	enum intr_level old_level;
+
+	ASSERT (is_thread (t));
+
+	old_level = intr_disable ();
+	if (t->status == THREAD_READY && t->ready_priority != t->priority) {
+		ready_queue_remove (t);
+		ready_queue_push (t);
+	} else if (t->status == THREAD_BLOCKED && t->wait_on_sema != NULL)
+		sema_requeue (t);
+	else if (t->status == THREAD_BLOCKED && t->wait_on_lock != NULL)
+		lock_requeue (t);
+	intr_set_level (old_level);
+}
+
+/* Moves the running thread into the EDF class with a budget of
+   RUNTIME ticks every PERIOD ticks, starting a period now.  The
+   thread is admitted only if the total EDF bandwidth stays
+   within EDF_UTIL_MAX; returns false, leaving the thread as it
+   was, otherwise.  A RUNTIME of 0 leaves the EDF class. */
+bool
+thread_set_deadline (int64_t runtime, int64_t period) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+	int util;
+
+	ASSERT (runtime >= 0);
+
+	if (runtime > 0 && (period <= 0 || runtime > period))
+		return false;
+	util = runtime == 0 ? 0 : (runtime * 1000 + period - 1) / period;
+
+	old_level = intr_disable ();
+	if (edf_util - t->dl_util + util > EDF_UTIL_MAX) {
+		intr_set_level (old_level);
+		return false;
+	}
+	edf_util += util - t->dl_util;
+	edf_unthrottle (t);
+	t->dl_util = util;
+	t->dl_runtime = runtime;
+	t->dl_period = runtime == 0 ? 0 : period;
+	t->dl_release = timer_ticks ();
+	t->dl_deadline = t->dl_release + period;
+	t->dl_budget = runtime;
+	intr_set_level (old_level);
+
+	/* Leaving the class may leave us outranked. */
+	if (runtime == 0)
+		try_thread_yield ();
+	return true;
+}
+
+/* Ends the running EDF thread's job for this period: sleeps until
+   the next period starts and then refills the budget.  Returns
+   true if the job finished by its deadline.  A job that finishes
+   late starts the next period right away. */
+bool
+thread_wait_period (void) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+	int64_t now, next;
+	bool met;
+
+	ASSERT (!intr_context ());
+	ASSERT (t->dl_period != 0);
+
+	old_level = intr_disable ();
+	now = timer_ticks ();
+	/* A throttled thread's period has already been moved on to
+	   the one it is waiting for. */
+	next = t->dl_throttled ? t->dl_release : t->dl_release + t->dl_period;
+	edf_unthrottle (t);
+	met = now <= next;
+	if (next < now)
+		next = now;
+	t->dl_release = next;
+	t->dl_deadline = next + t->dl_period;
+	t->dl_budget = t->dl_runtime;
+	intr_set_level (old_level);
+	if (next > now)
+		thread_sleep (next);
+	return met;
 }
 
 /* Returns the current thread's priority. */
@@ -420,28 +874,73 @@ int calculate_advanced_priority(struct thread* t){
 	int advanced_priority;
 	advanced_priority = PRI_MAX - ROUND_TO_INT(DIV_INT(t->recent_cpu, 4)) - t->nice_value * 2;
 	
-	// if (advanced_priority > PRI_MAX){
-	// 	advanced_priority = PRI_MAX;
-	// } else if (advanced_priority < PRI_MIN){
-	// 	advanced_priority = PRI_MIN;
-	// }
+	/* run queue는 우선순위별로 나뉘어 있으므로 범위를 벗어나면 안 된다. */
+	if (advanced_priority > PRI_MAX){
+		advanced_priority = PRI_MAX;
+	} else if (advanced_priority < PRI_MIN){
+		advanced_priority = PRI_MIN;
+	}
 	
 
 	return advanced_priority;
 }
 
+/* Recalculates the priority of every thread whose recent_cpu
+   changed since the last call, moving ready ones to their new run
+   queue.  Called from the timer interrupt every fourth tick. */
 void calculate_all_priority(){
-	if (list_empty(&all_list))
-		return;
-	
-	// calculating_recent_cpu(thread_current());
-	struct list_elem*e = list_front(&all_list);
 	struct thread *t;
-	int new_priority;
-	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)){
-		t = list_entry(e, struct thread, all_elem);
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (!list_empty(&mlfqs_dirty)){
+		t = list_entry(list_pop_front(&mlfqs_dirty), struct thread, mlfqs_elem);
+		t->mlfqs_dirty = false;
 		t->priority = calculate_advanced_priority(t);
-	}	
+		update_time_slice(t);
+		thread_requeue(t);
+	}
+
+	/* 실행 중인 쓰레드보다 우선순위가 높은 쓰레드가 생겼다면 양보 */
+	if (thread_current() != idle_thread
+	    && thread_current()->priority < ready_queue_max_priority())
+		intr_yield_on_return();
+}
+
+/* Sets T's time slice from its priority.  Under MLFQS, priority
+   falls as a thread uses the CPU, so the slice grows from half
+   the base slice for the top quarter of priorities to four times
+   it for the bottom quarter: CPU-bound threads switch less often
+   and interactive ones get the CPU back sooner.  Otherwise every
+   thread gets the base slice. */
+static void
+update_time_slice (struct thread *t) {
+	if (thread_mlfqs) {
+		unsigned slice = (thread_time_slice << ((PRI_MAX - t->priority) / 16)) / 2;
+		t->time_slice = slice > 0 ? slice : 1;
+	} else
+		t->time_slice = thread_time_slice;
+}
+
+/* Queues T for the next calculate_all_priority(). */
+static void
+mark_mlfqs_dirty (struct thread *t) {
+	if (!t->mlfqs_dirty){
+		t->mlfqs_dirty = true;
+		list_push_back(&mlfqs_dirty, &t->mlfqs_elem);
+	}
+}
+
+/* Charges the running thread for the current timer tick. */
+void increase_recent_cpu(void){
+	struct thread *t = thread_current();
+
+	ASSERT(thread_mlfqs);
+	if (t == idle_thread)
+		return;
+
+	t->recent_cpu = ADD_INT(t->recent_cpu, 1);
+	mark_mlfqs_dirty(t);
 }
 
 /* Sets the current thread's nice value to NICE. */
@@ -469,7 +968,7 @@ thread_get_nice (void) {
 void 
 update_load_avg(){
 	ASSERT(thread_mlfqs == true)
-	int ready = list_size(&ready_list);;
+	int ready = ready_cnt;
 	struct thread* t = thread_current();
 
 	if (t != idle_thread)
@@ -502,16 +1001,22 @@ calculating_recent_cpu(struct thread* t){
 	return recent;
 }
 
+/* Decays the recent_cpu of every thread.  Threads whose value
+   does not change (recent_cpu and nice both 0) keep their
+   priority and are not queued for recalculation. */
 void calc_all_recent_cpu(){
-	if (list_empty(&all_list))
-		return;
-	
-	// calculating_recent_cpu(thread_current());
-	struct list_elem*e = list_front(&all_list);
+	struct list_elem *e;
 	struct thread *t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
 	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)){
 		t = list_entry(e, struct thread, all_elem);
-		calculating_recent_cpu(t);
+		if (t == idle_thread)
+			continue;
+		int old_recent_cpu = t->recent_cpu;
+		if (calculating_recent_cpu(t) != old_recent_cpu)
+			mark_mlfqs_dirty(t);
 	}	
 }
 
@@ -528,28 +1033,6 @@ thread_get_recent_cpu (void) {
 	return return_value;
 }
 
-void update_all_priority()
-{
-	ASSERT(thread_mlfqs);
-	struct list_elem *e;
-	struct thread *t;
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
-	{
-		t = list_entry(e, struct thread, all_elem);
-		update_priority(t);
-	}
-}
-
-void update_priority(struct thread *t)
-{
-	ASSERT(thread_mlfqs);
-	if (t != idle_thread)
-	{
-		int _priority = PRI_MAX- ROUND_TO_INT(DIV_INT(thread_current()->recent_cpu, 4)) - (thread_current()->nice_value*2);
-		t->priority = _priority;
-	}
-}
-
 /* Idle thread.  Executes when no other thread is ready to run.
 
    The idle thread is initially put on the ready list by
@@ -582,8 +1065,14 @@ idle (void *idle_started_ UNUSED) {
 		   time.
 
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
-		   7.11.1 "HLT Instruction". */
+		   7.11.1 "HLT Instruction".
+
+		   With -tickless, the timer is first reprogrammed so that
+		   the next interrupt comes at the next sleep deadline
+		   rather than at the next tick. */
+		timer_idle_enter ();
 		asm volatile ("sti; hlt" : : : "memory");
+		timer_idle_exit ();
 	}
 }
 
@@ -601,7 +1090,8 @@ kernel_thread (thread_func *function, void *aux) {
 /* Does basic initialization of T as a blocked thread named
    NAME. */
 static void
-init_thread (struct thread *t, const char *name, int priority) {
+init_thread (struct thread *t, const char *name, int priority,
+		struct process *proc) {
 	ASSERT (t != NULL);
 	ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
 	ASSERT (name != NULL);
@@ -612,25 +1102,33 @@ init_thread (struct thread *t, const char *name, int priority) {
 	t->tf.rsp = (uint64_t) t + PGSIZE - sizeof (void *);
 	t->priority = priority;
 	t->original_priority = priority;
+	update_time_slice (t);
 	t->magic = THREAD_MAGIC;
+	t->intr_slot = -1;
 	t->has_lock = 0;
 	t->wait_on_lock = NULL;
+	t->wait_on_sema = NULL;
 	
-	list_init(&t->donors);
+	heap_init(&t->held_locks, lock_priority_less, NULL);
+	heap_init(&t->held_rwlocks, rwlock_hold_less, NULL);
+	/* The timer interrupt walks all_list under MLFQS. */
+	enum intr_level old_level = intr_disable ();
 	list_push_back(&all_list, &t->all_elem);
-	list_init(&t->fd_table);
-	//merged - check
-#ifdef USERPROG
-	list_init(&t->fd_table);
-	list_init(&t->child_list);
-	sema_init(&t->wait_sema, 0);
-	sema_init(&t->exit_sema, 0);
-	sema_init(&t->process_sema, 0);
-	list_init(&t->process_sema.waiters);
-	t->last_created_fd = 2;
-
-	// sema_init(&t->process_sema, 0);
-#endif
+	intr_set_level (old_level);
+
+	memset (proc, 0, sizeof *proc);
+	t->proc = proc;
+	proc->thread = t;
+	list_init(&proc->fd_table);
+	list_init(&proc->child_list);
+	sema_init(&proc->wait_sema, 0);
+	sema_init(&proc->exit_sema, 0);
+	sema_init(&proc->process_sema, 0);
+	proc->last_created_fd = 2;
+	proc->leader = proc;
+	lock_init(&proc->lock);
+	sema_init(&proc->uthread_sema, 0);
+	proc->stack_slot = -1;
 
 	if (thread_mlfqs == true){
 		// if (t == initial_thread){
@@ -640,7 +1138,6 @@ init_thread (struct thread *t, const char *name, int priority) {
 		// 	t->nice_value = thread_get_nice();
 		// 	t->recent_cpu = thread_current()->recent_cpu;
 		// }
-		list_push_back(&all_list, &t->all_elem);
 	}
  }
 
@@ -651,10 +1148,100 @@ init_thread (struct thread *t, const char *name, int priority) {
    idle_thread. */
 static struct thread *
 next_thread_to_run (void) {
-	if (list_empty (&ready_list))
+	if (ready_cnt == 0)
 		return idle_thread;
 	else
-		return list_entry (list_pop_front (&ready_list), struct thread, elem);
+		return ready_queue_pop ();
+}
+
+/* Appends T to the back of the run queue for its priority, or
+   adds it to the EDF queue if T is in the EDF class and not
+   throttled. */
+static void
+ready_queue_push (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	t->ready_priority = t->priority;
+	ready_cnt++;
+	if (edf_class (t)) {
+		heap_push (&edf_queue, &t->dl_elem);
+		return;
+	}
+	list_push_back (&ready_queues[t->ready_priority], &t->elem);
+	ready_bitmap |= 1ULL << t->ready_priority;
+}
+
+/* Unlinks T from the run queue. */
+static void
+ready_queue_remove (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	ready_cnt--;
+	if (edf_class (t)) {
+		heap_remove (&edf_queue, &t->dl_elem);
+		return;
+	}
+	list_remove (&t->elem);
+	if (list_empty (&ready_queues[t->ready_priority]))
+		ready_bitmap &= ~(1ULL << t->ready_priority);
+}
+
+/* Removes and returns the EDF thread with the earliest deadline,
+   or else the first thread of the highest non-empty queue.  The
+   run queue must not be empty. */
+static struct thread *
+ready_queue_pop (void) {
+	int pri;
+	struct thread *t;
+
+	if (!heap_empty (&edf_queue)) {
+		ready_cnt--;
+		return heap_entry (heap_pop_max (&edf_queue), struct thread, dl_elem);
+	}
+
+	pri = ready_queue_max_priority ();
+	ASSERT (pri >= PRI_MIN);
+
+	t = list_entry (list_front (&ready_queues[pri]), struct thread, elem);
+	ready_queue_remove (t);
+	return t;
+}
+
+/* Returns the highest priority among the ready threads, or -1 if
+   the run queue is empty.  A ready EDF thread counts as
+   PRI_MAX + 1. */
+static int
+ready_queue_max_priority (void) {
+	if (!heap_empty (&edf_queue))
+		return PRI_MAX + 1;
+	if (ready_bitmap == 0)
+		return -1;
+	return 63 - __builtin_clzll (ready_bitmap);
+}
+
+/* Returns true if there is a ready thread that should run
+   instead of T. */
+static bool
+ready_queue_outranks (struct thread *t) {
+	if (t == idle_thread)
+		return ready_cnt != 0;
+	if (edf_class (t)) {
+		struct heap_elem *e = heap_max (&edf_queue);
+		return e != NULL && edf_later (&t->dl_elem, e, NULL);
+	}
+	return t->priority < ready_queue_max_priority ();
+}
+
+/* Orders EDF threads so that heap_pop_max() returns the one with
+   the earliest deadline. */
+static bool
+edf_later (const struct heap_elem *a_, const struct heap_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, dl_elem);
+	const struct thread *b = heap_entry (b_, struct thread, dl_elem);
+
+	return a->dl_deadline > b->dl_deadline;
 }
 
 /* Use iretq to launch the thread */
@@ -765,7 +1352,7 @@ do_schedule(int status) {
 	while (!list_empty (&destruction_req)) {
 		struct thread *victim =
 			list_entry (list_pop_front (&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		thread_page_put (victim);
 	}
 	thread_current ()->status = status;
 	schedule ();
@@ -781,6 +1368,7 @@ schedule (void) {
 	ASSERT (is_thread (next));
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
+	fpu_switch (next);
 
 	/* Start new time slice. */
 	thread_ticks = 0;
@@ -791,6 +1379,13 @@ schedule (void) {
 #endif
 
 	if (curr != next) {
+		uint64_t now = rdtsc ();
+		enum sched_reason reason = curr->status == THREAD_READY ? SCHED_YIELD
+			: curr->status == THREAD_DYING ? SCHED_EXIT : SCHED_BLOCK;
+
+		sched_account (now, curr, next);
+		sched_trace_record (now, curr, next, reason);
+
 		/* If the thread we switched from is dying, destroy its struct
 		   thread. This must happen late so that thread_exit() doesn't
 		   pull out the rug under itself.
@@ -830,48 +1425,118 @@ void thread_sleep(int64_t ticks){
 	t->sleep_ticks = ticks;
 
 	old_level = intr_disable();
-	list_insert_ordered(&sleep_list, &t->elem, sleep_list_order, NULL);
+	sleep_wheel_add(t);
 	thread_block();
 	intr_set_level(old_level);
 }
 
-
+/* Advances the sleep wheel up to and including tick TICKS and
+   moves every thread whose sleep_ticks has passed to the run
+   queue. */
 void thread_wakeup(int64_t ticks) {
   enum intr_level old_level;
   old_level = intr_disable();
 
-  while (!list_empty(&sleep_list)) {
-    struct list_elem *waking_up = list_front(&sleep_list);
-    struct thread *checker = list_entry(waking_up, struct thread, elem);
+  while (wheel_ticks <= ticks) {
+    int idx = wheel_ticks & WHEEL_ROOT_MASK;
+    struct list *slot = &wheel_root[idx];
+
+    /* The root wheel wrapped around: refill it from the next
+       level, which in turn may need a refill from its own. */
+    if (idx == 0) {
+      for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+        int lvl_idx = (wheel_ticks >> WHEEL_SHIFT (lvl)) & WHEEL_LVL_MASK;
+        sleep_wheel_cascade(lvl, lvl_idx);
+        if (lvl_idx != 0)
+          break;
+      }
+    }
 
-    if (checker->sleep_ticks <= (ticks)) {
-      waking_up = list_pop_front(&sleep_list);
-	  checker->sleep_ticks = 0;
-      list_insert_ordered(&ready_list, waking_up, priority_scheduling, NULL);
-    } else {
-      break;
+    while (!list_empty(slot)) {
+      struct thread *checker = list_entry(list_pop_front(slot), struct thread, elem);
+      checker->sleep_ticks = 0;
+      ready_queue_push(checker);
+      checker->status = THREAD_READY;
+      checker->acct_stamp = rdtsc();
     }
+    wheel_ticks++;
   }
 
+  /* A woken thread that outranks the running one, such as an EDF
+     thread whose next period just started, should not have to wait
+     for the rest of its time slice. */
+  if (intr_context() && ready_queue_outranks(thread_current()))
+    intr_yield_on_return();
+
   intr_set_level(old_level);
 
 }
 
-void apply_to_all(){
-	struct list_elem *e;
-	struct thread *t;
-	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)){
-		t = list_entry(e, struct thread, all_elem);
-		calculating_recent_cpu(t);
+/* Returns the first tick at which thread_wakeup() has work to do,
+   looking at most LIMIT ticks ahead.  Returns the tick LIMIT ticks
+   ahead if there is none.  Must be called with interrupts off. */
+int64_t
+thread_next_wakeup (int64_t limit) {
+	int64_t t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (t = wheel_ticks; t < wheel_ticks + limit; t++) {
+		/* Cascading may move a sleeper due on this very tick
+		   into the root wheel. */
+		if ((t & WHEEL_ROOT_MASK) == 0
+		    || !list_empty (&wheel_root[t & WHEEL_ROOT_MASK]))
+			return t;
 	}
+	return t;
 }
 
-static bool sleep_list_order(const struct list_elem *a_, const struct list_elem *b_,
-            void *aux UNUSED){
-  const struct thread *a = list_entry (a_, struct thread, elem);
-  const struct thread *b = list_entry (b_, struct thread, elem);
+/* Links sleeping thread T into the wheel slot for its
+   sleep_ticks.  A deadline less than WHEEL_ROOT_SIZE ticks away
+   goes straight into the root wheel; otherwise it goes into the
+   lowest level whose span covers it, and is cascaded down when
+   the root wheel wraps around to it.  A deadline that has
+   already passed fires on the next processed tick, and one
+   beyond the whole wheel is parked at its far end and
+   re-inserted from there. */
+static void
+sleep_wheel_add (struct thread *t) {
+	int64_t expires = t->sleep_ticks;
+	int64_t delta = expires - wheel_ticks;
+	struct list *slot;
+	int lvl;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (delta < 0)
+		slot = &wheel_root[wheel_ticks & WHEEL_ROOT_MASK];
+	else if (delta < WHEEL_ROOT_SIZE)
+		slot = &wheel_root[expires & WHEEL_ROOT_MASK];
+	else {
+		if (delta >= WHEEL_SPAN) {
+			delta = WHEEL_SPAN - 1;
+			expires = wheel_ticks + delta;
+		}
+		for (lvl = 0; delta >= (int64_t) 1 << WHEEL_SHIFT (lvl + 1); lvl++)
+			continue;
+		slot = &wheel_lvl[lvl][(expires >> WHEEL_SHIFT (lvl)) & WHEEL_LVL_MASK];
+	}
+	list_push_back (slot, &t->elem);
+}
 
-  return a->sleep_ticks < b->sleep_ticks;
+/* Re-inserts every thread in slot IDX of upper level LVL, which
+   moves each of them at least one level down. */
+static void
+sleep_wheel_cascade (int lvl, int idx) {
+	struct list *slot = &wheel_lvl[lvl][idx];
+	struct list pending;
+
+	/* Detach the slot first: a parked far-future sleeper may be
+	   re-inserted into this very slot. */
+	list_init (&pending);
+	list_splice (list_end (&pending), list_begin (slot), list_end (slot));
+	while (!list_empty (&pending))
+		sleep_wheel_add (list_entry (list_pop_front (&pending), struct thread, elem));
 }
 
 bool priority_scheduling(const struct list_elem *a_, const struct list_elem *b_,
@@ -897,7 +1562,7 @@ int allocate_fd(struct file *file, struct list *fd_table)
 	file_descriptor = malloc(sizeof(struct file_descriptor));
 	if(file_descriptor == NULL)
 		return -1;
-	file_descriptor->fd = (thread_current()->last_created_fd)++;
+	file_descriptor->fd = (thread_current()->proc->last_created_fd)++;
 	file_descriptor->file = file;
 	list_push_back(fd_table,&file_descriptor->fd_elem);
 	return file_descriptor->fd;
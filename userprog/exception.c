@@ -52,8 +52,7 @@ void exception_init(void)
     intr_register_int(0, 0, INTR_ON, kill, "#DE Divide Error");
     intr_register_int(1, 0, INTR_ON, kill, "#DB Debug Exception");
     intr_register_int(6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
-    intr_register_int(7, 0, INTR_ON, kill,
-                      "#NM Device Not Available Exception");
+    /* #NM (vector 7) is the lazy FPU switch, see threads/fpu.c. */
     intr_register_int(11, 0, INTR_ON, kill, "#NP Segment Not Present");
     intr_register_int(12, 0, INTR_ON, kill, "#SS Stack Fault Exception");
     intr_register_int(13, 0, INTR_ON, kill, "#GP General Protection Exception");
@@ -95,7 +94,7 @@ kill(struct intr_frame *f)
         printf("%s: dying due to interrupt %#04llx (%s).\n",
                thread_name(), f->vec_no, intr_name(f->vec_no));
         intr_dump_frame(f);
-        thread_exit();
+        exit(-1);
 
     case SEL_KCSEG:
         /* Kernel's code segment, which indicates a kernel bug.
@@ -12,8 +12,10 @@
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
@@ -29,10 +31,25 @@
 static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
+static void uthread_start(void *aux UNUSED);
+#ifndef VM
+static bool install_page(void *upage, void *kpage, bool writable);
+#endif
+static void uthread_release(struct process *leader, int slot);
 
 void argument_stack(char **argv, int argc, struct intr_frame *if_);
 struct thread *get_thread_from_tid(tid_t thread_id);
 
+static void process_unregister(struct thread *child);
+
+/* Every thread from thread_create() until its parent reaps it,
+   keyed by tid, so that wait and fork find a child without
+   walking the parent's child_list.  An exited child stays in the
+   table, blocked on its exit_sema, until process_wait() takes its
+   exit status, so an entry never points at a freed thread. */
+static struct hash tid_table;
+static struct lock tid_table_lock;
+
 struct parent_info
 {
     struct thread *parent;
@@ -152,7 +169,7 @@ tid_t process_fork(const char *name, struct intr_frame *if_)
     my_data.parent_f = if_;
 
     struct thread *cur = thread_current();
-    memcpy(&cur->parent_tf, my_data.parent_f, sizeof(struct intr_frame));
+    memcpy(&cur->proc->parent_tf, my_data.parent_f, sizeof(struct intr_frame));
 
     tid_t tid = thread_create(name, PRI_DEFAULT, __do_fork, &my_data);
     if (tid == TID_ERROR)
@@ -161,10 +178,11 @@ tid_t process_fork(const char *name, struct intr_frame *if_)
     }
 
     struct thread *child = get_thread_from_tid(tid);
-    sema_down(&child->process_sema);
-    if (child->exit_status == TID_ERROR)
+    sema_down(&child->proc->process_sema);
+    if (child->proc->exit_status == TID_ERROR)
     {
-        sema_up(&child->exit_sema);
+        process_unregister(child);
+        sema_up(&child->proc->exit_sema);
 
         return TID_ERROR;
     }
@@ -263,20 +281,24 @@ __do_fork(struct parent_info *aux)
     // printf("copt start\n");
 #ifdef VM
     supplemental_page_table_init(&current->spt);
-    if (!supplemental_page_table_copy(&current->spt, &parent->spt))
+    if (!supplemental_page_table_copy(&current->spt, thread_spt(parent)))
         goto error;
 #else
     if (!pml4_for_each(parent->pml4, duplicate_pte, parent))
         goto error;
 #endif
+    if (!fpu_fork(current, parent))
+        goto error;
     /* TODO: Your code goes here.
      * TODO: Hint) To duplicate the file object, use `file_duplicate`
      * TODO:       in include/filesys/file.h. Note that parent should not return
      * TODO:       from the fork() until this function successfully duplicates
      * TODO:       the resources of parent.*/
 
-    struct list_elem *e = list_begin(&parent->fd_table);
-    struct list *parent_list = &parent->fd_table;
+    struct process *files = parent->proc->leader;
+    lock_acquire(&files->lock);
+    struct list_elem *e = list_begin(&files->fd_table);
+    struct list *parent_list = &files->fd_table;
     if (!list_empty(parent_list))
     {
         for (e; e != list_end(parent_list); e = list_next(e))
@@ -287,28 +309,29 @@ __do_fork(struct parent_info *aux)
                 struct file_descriptor *child_fd = malloc(sizeof(struct file_descriptor));
                 child_fd->file = file_duplicate(parent_fd->file);
                 child_fd->fd = parent_fd->fd;
-                list_push_back(&current->fd_table, &child_fd->fd_elem);
+                list_push_back(&current->proc->fd_table, &child_fd->fd_elem);
             }
-            current->last_created_fd = parent->last_created_fd;
+            current->proc->last_created_fd = files->last_created_fd;
         }
-        current->last_created_fd = parent->last_created_fd;
+        current->proc->last_created_fd = files->last_created_fd;
     }
     else
     {
-        current->last_created_fd = parent->last_created_fd;
+        current->proc->last_created_fd = files->last_created_fd;
     }
+    lock_release(&files->lock);
 
     if_.R.rax = 0;
 
     // 로드가 완료될 때까지 기다리고 있던 부모 대기 해제
-    sema_up(&current->process_sema);
+    sema_up(&current->proc->process_sema);
     process_init();
 
     /* Finally, switch to the newly created process. */
     if (succ)
         do_iret(&if_);
 error:
-    sema_up(&current->process_sema);
+    sema_up(&current->proc->process_sema);
     exit(TID_ERROR);
 }
 
@@ -324,6 +347,14 @@ int process_exec(void *f_name)
     char *file_name = f_name;
     bool success;
 
+    /* Other threads still run in the address space we would replace. */
+    struct process *proc = thread_current()->proc;
+    if (proc->leader != proc || proc->uthread_cnt > 0)
+    {
+        palloc_free_page(file_name);
+        return -1;
+    }
+
     /* We cannot use the intr_frame in the thread structure.
      * This is because when current thread rescheduled,
      * it stores the execution information to the member.
@@ -337,6 +368,7 @@ int process_exec(void *f_name)
 
     /* We first kill the current context */
     process_cleanup();
+    fpu_reset();
 
     /* And then load the binary */
     lock_acquire(&filesys_lock);
@@ -348,7 +380,9 @@ int process_exec(void *f_name)
     palloc_free_page(file_name);
     if (!success)
         return -1;
-    /* Start switched process. */
+    /* Start switched process.  The exec() call never returns
+       through syscall_handler()'s statistics scope. */
+    intr_stats_abandon();
     do_iret(&_if);
     NOT_REACHED();
 }
@@ -373,12 +407,222 @@ int process_wait(tid_t child_tid)
         return -1;
     }
 
-    sema_down(&t->wait_sema);
-    list_remove(&t->child_list_elem);
+    sema_down(&t->proc->wait_sema);
+    process_unregister(t);
+
+    /* 자식은 exit_sema 이후 자신의 struct process를 해제하므로 먼저 읽어 둔다 */
+    int exit_status = t->proc->exit_status;
+    sema_up(&t->proc->exit_sema);
+
+    return exit_status;
+}
+
+/* Top of the main thread's stack area and the largest size it may
+   grow to; see vm_try_handle_fault().  Thread stacks go below it. */
+#define MAIN_STACK_MAX 0x100000
+
+/* Returns the top of user stack slot SLOT.  Slots are separated by
+   an unmapped guard page, so an overflow faults instead of running
+   into the next thread's stack. */
+static uint8_t *
+uthread_stack_top(int slot)
+{
+    return (uint8_t *)USER_STACK - MAIN_STACK_MAX - PGSIZE
+           - (uint64_t)slot * (UTHREAD_STACK_PAGES + 1) * PGSIZE;
+}
+
+/* Maps the user stack of slot SLOT into the current address space
+   unless an earlier thread with this slot already did.  With VM
+   the pages are only reserved in the SPT and claimed on first
+   touch. */
+static bool
+uthread_stack_alloc(int slot)
+{
+    uint8_t *top = uthread_stack_top(slot);
+
+    for (int i = 1; i <= UTHREAD_STACK_PAGES; i++)
+    {
+        uint8_t *upage = top - i * PGSIZE;
+#ifdef VM
+        if (spt_find_page(thread_spt(thread_current()), upage) == NULL
+            && !vm_alloc_page(VM_ANON | VM_MARKER_0, upage, true))
+            return false;
+#else
+        if (pml4_get_page(thread_current()->pml4, upage) == NULL)
+        {
+            uint8_t *kpage = palloc_get_page(PAL_USER | PAL_ZERO);
+            if (kpage == NULL)
+                return false;
+            if (!install_page(upage, kpage, true))
+            {
+                palloc_free_page(kpage);
+                return false;
+            }
+        }
+#endif
+    }
+    return true;
+}
+
+/* Start-up information for a thread made by
+   process_uthread_create(). */
+struct uthread_args
+{
+    struct process *leader;   /* Process whose address space to join. */
+    int slot;                 /* User stack slot. */
+    struct intr_frame if_;    /* Initial user context. */
+};
+
+/* Creates a thread that runs in the current process's address
+   space and shares its file descriptors.  It starts in user mode
+   at ENTRY with ARG0 and ARG1 as its first two arguments, on a
+   stack of its own.  Returns its thread id, or TID_ERROR if it
+   cannot be created.  The new thread is a child of the caller, so
+   only the caller can process_uthread_join() it. */
+tid_t process_uthread_create(uintptr_t entry, uint64_t arg0, uint64_t arg1)
+{
+    struct thread *cur = thread_current();
+    struct process *leader = cur->proc->leader;
+    struct uthread_args *args;
+    int slot = -1;
+    tid_t tid;
+
+    if (!is_user_vaddr(entry))
+        return TID_ERROR;
+    args = malloc(sizeof *args);
+    if (args == NULL)
+        return TID_ERROR;
+
+    lock_acquire(&leader->lock);
+    if (leader->stack_slots != UINT32_MAX)
+    {
+        slot = __builtin_ctz(~leader->stack_slots);
+        leader->stack_slots |= 1u << slot;
+        leader->uthread_cnt++;
+    }
+    lock_release(&leader->lock);
+    if (slot < 0)
+    {
+        free(args);
+        return TID_ERROR;
+    }
+
+    if (!uthread_stack_alloc(slot))
+        goto error;
+
+    memset(&args->if_, 0, sizeof args->if_);
+    args->if_.ds = args->if_.es = args->if_.ss = SEL_UDSEG;
+    args->if_.cs = SEL_UCSEG;
+    args->if_.eflags = FLAG_IF | FLAG_MBS;
+    args->if_.rip = entry;
+    args->if_.R.rdi = arg0;
+    args->if_.R.rsi = arg1;
+    /* As if ENTRY had just been called, with no return address. */
+    args->if_.rsp = (uintptr_t)uthread_stack_top(slot) - sizeof(void *);
+    args->leader = leader;
+    args->slot = slot;
+
+    /* process_register() hands ARGS to the new thread before it can
+       run, so that it is known to be ours as soon as it exists. */
+    cur->proc->spawning = args;
+    tid = thread_create(cur->name, thread_get_priority(), uthread_start, NULL);
+    cur->proc->spawning = NULL;
+    if (tid != TID_ERROR)
+        return tid;
+
+error:
+    uthread_release(leader, slot);
+    free(args);
+    return TID_ERROR;
+}
+
+/* Thread function of a thread made by process_uthread_create().
+   process_register() has already joined it to its process. */
+static void
+uthread_start(void *aux UNUSED)
+{
+    struct thread *t = thread_current();
+    struct uthread_args *args = t->proc->spawning;
+    struct intr_frame if_ = args->if_;
+
+    t->proc->spawning = NULL;
+    free(args);
 
-    sema_up(&t->exit_sema);
+    process_activate(t);
+    do_iret(&if_);
+    NOT_REACHED();
+}
 
-    return t->exit_status;
+/* Gives stack slot SLOT back to LEADER and tells it that one of
+   its threads is gone. */
+static void
+uthread_release(struct process *leader, int slot)
+{
+    lock_acquire(&leader->lock);
+    leader->stack_slots &= ~(1u << slot);
+    leader->uthread_cnt--;
+    lock_release(&leader->lock);
+    sema_up(&leader->uthread_sema);
+}
+
+/* Waits for thread TID, made by process_uthread_create() in the
+   current thread, to exit and returns its exit status.  Returns
+   -1 right away if TID is not such a thread or was already
+   joined. */
+int process_uthread_join(tid_t tid)
+{
+    struct thread *t = get_thread_from_tid(tid);
+
+    if (t == NULL || t->proc->leader == t->proc)
+        return -1;
+    return process_wait(tid);
+}
+
+/* Ends the calling thread with STATUS.  In a thread made by
+   process_uthread_create() this ends only that thread; in the
+   main thread it ends the process once the other threads are
+   done. */
+void process_uthread_exit(int status)
+{
+    thread_current()->proc->exit_status = status;
+    thread_exit();
+}
+
+/* Ends the whole process with STATUS, whichever of its threads
+   calls it.  The other threads die the next time they would
+   return to user mode, and any of them asleep on a futex is woken
+   for that; the main thread then waits for them in
+   process_exit().  The first caller's STATUS wins.
+
+   Only futex sleepers are woken.  A thread blocked in wait() for
+   a child process or in a read from the console keeps the process
+   alive until that call returns on its own.  A thread blocked in
+   uthread_join() returns once the sibling it joins dies, which
+   that sibling does unless it is itself blocked like that. */
+void process_exit_group(int status)
+{
+    struct process *leader = thread_current()->proc->leader;
+    bool first;
+
+    lock_acquire(&leader->lock);
+    first = !leader->dying;
+    if (first)
+    {
+        leader->dying = true;
+        leader->exit_status = status;
+    }
+    lock_release(&leader->lock);
+
+    if (first)
+        futex_kill(leader);
+    thread_exit();
+}
+
+/* Returns true if the current thread belongs to a process that is
+   exiting, so that it must not go back to user mode. */
+bool process_dying(void)
+{
+    return thread_current()->proc->leader->dying;
 }
 
 /* Exit the process. This function is called by thread_exit (). */
@@ -390,27 +634,51 @@ void process_exit(void)
      * TODO: project2/process_termination.html).
      * TODO: We recommend you to implement process resource cleanup here. */
     struct thread *t = thread_current();
+    struct process *proc = t->proc;
+
+    if (proc->leader != proc)
+    {
+        /* A thread of a multithreaded process: the address space and
+           the files stay with the leader, which must not tear them
+           down until we have switched away from its page table. */
+        t->pml4 = NULL;
+        pml4_activate(NULL);
+        uthread_release(proc->leader, proc->stack_slot);
+        sema_up(&proc->wait_sema);
+        sema_down(&proc->exit_sema);
+        return;
+    }
+
+    /* The process ends once all of its threads have exited. */
+    lock_acquire(&proc->lock);
+    while (proc->uthread_cnt > 0)
+    {
+        lock_release(&proc->lock);
+        sema_down(&proc->uthread_sema);
+        lock_acquire(&proc->lock);
+    }
+    lock_release(&proc->lock);
 
     if (t->pml4 != NULL)
     {
-        printf("%s: exit(%d)\n", t->name, t->exit_status);
-        file_close(t->running);
-        t->running = NULL;
+        printf("%s: exit(%d)\n", t->name, t->proc->exit_status);
+        file_close(t->proc->running);
+        t->proc->running = NULL;
     }
 
-    struct list *exit_list = &t->fd_table;
+    struct list *exit_list = &t->proc->fd_table;
     struct list_elem *e = list_begin(&exit_list);
-    for (int i = 2; i <= t->last_created_fd; ++i)
+    for (int i = 2; i <= t->proc->last_created_fd; ++i)
     {
         close(i);
     }
 
-    file_close(t->running);
+    file_close(t->proc->running);
     process_cleanup();
     hash_destroy(&t->spt.hash_table, NULL);
 
-    sema_up(&t->wait_sema);
-    sema_down(&t->exit_sema);
+    sema_up(&t->proc->wait_sema);
+    sema_down(&t->proc->exit_sema);
 }
 
 /* Free the current process's resources. */
@@ -634,7 +902,7 @@ load(const char *file_name, struct intr_frame *if_)
         }
     }
 
-    t->running = file;
+    t->proc->running = file;
 
     file_deny_write(file);
     /* Set up stack. */
@@ -925,20 +1193,82 @@ setup_stack(struct intr_frame *if_)
 }
 #endif /* VM */
 
-struct thread *get_thread_from_tid(tid_t thread_id)
+static uint64_t
+tid_hash(const struct hash_elem *e, void *aux UNUSED)
 {
+    const struct tid_key *k = hash_entry(e, struct tid_key, elem);
+    return hash_int(k->tid);
+}
 
-    struct thread *t = thread_current();
-    struct list *child_list = &t->child_list;
-    struct list_elem *e;
+static bool
+tid_less(const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED)
+{
+    const struct tid_key *a = hash_entry(a_, struct tid_key, elem);
+    const struct tid_key *b = hash_entry(b_, struct tid_key, elem);
+    return a->tid < b->tid;
+}
+
+/* Initializes the tid table.  Must be called before the first
+   thread_create(). */
+void process_table_init(void)
+{
+    hash_init(&tid_table, tid_hash, tid_less, NULL);
+    lock_init(&tid_table_lock);
+}
+
+/* Records CHILD, just made by thread_create(), as a child of the
+   current thread.  If the current thread is making a thread of its
+   own process, also joins CHILD to that process, before CHILD can
+   run. */
+void process_register(struct thread *child)
+{
+    struct process *p = child->proc;
+    struct uthread_args *args = thread_current()->proc->spawning;
 
-    for (e = list_begin(child_list); e != list_end(child_list); e = list_next(e))
+    p->parent = thread_current();
+    p->key.tid = child->tid;
+    if (args != NULL)
     {
-        t = list_entry(e, struct thread, child_list_elem);
-        if (t->tid == thread_id)
-        {
-            return t;
-        }
+        /* A thread of our process; see process_uthread_create(). */
+        p->leader = args->leader;
+        p->stack_slot = args->slot;
+        p->spawning = args;
+        child->pml4 = args->leader->thread->pml4;
+    }
+    list_push_back(&thread_current()->proc->child_list, &p->child_list_elem);
+
+    lock_acquire(&tid_table_lock);
+    hash_insert(&tid_table, &p->key.elem);
+    lock_release(&tid_table_lock);
+}
+
+/* Forgets CHILD once its parent has reaped it. */
+static void process_unregister(struct thread *child)
+{
+    struct process *p = child->proc;
+
+    list_remove(&p->child_list_elem);
+    lock_acquire(&tid_table_lock);
+    hash_delete(&tid_table, &p->key.elem);
+    lock_release(&tid_table_lock);
+}
+
+/* Returns the child of the current thread with tid THREAD_ID, or
+   NULL if there is none or it was already reaped. */
+struct thread *get_thread_from_tid(tid_t thread_id)
+{
+    struct tid_key key = {.tid = thread_id};
+    struct hash_elem *e;
+    struct thread *t = NULL;
+
+    lock_acquire(&tid_table_lock);
+    e = hash_find(&tid_table, &key.elem);
+    if (e != NULL)
+    {
+        struct process *p = hash_entry(e, struct process, key.elem);
+        if (p->parent == thread_current())
+            t = p->thread;
     }
-    return NULL;
+    lock_release(&tid_table_lock);
+    return t;
 }
\ No newline at end of file
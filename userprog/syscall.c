@@ -16,6 +16,9 @@
 #include "lib/string.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
+#include "threads/mmu.h"
+#include "threads/vaddr.h"
+#include <hash.h>
 
 #include "vm/vm.h"
 
@@ -38,6 +41,9 @@ void close(int fd);
 
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
+int futex_wait(int *addr, int expected);
+int futex_wake(int *addr, int n);
+bool intr_stats(int vec, struct intr_stats *stats);
 
 int insert_file_fdt(struct file *file);
 int process_add_file(struct file *f);
@@ -66,10 +72,12 @@ struct file_descriptor *find_file_descriptor(int fd);
 #define MSR_LSTAR 0xc0000082        /* Long mode SYSCALL target */
 #define MSR_SYSCALL_MASK 0xc0000084 /* Mask for the eflags */
 
-struct file_descriptor *find_file_descriptor(int fd)
+/* Looks up FD in the file descriptors of process P, which are
+   shared by all of its threads.  P's lock must be held. */
+static struct file_descriptor *fd_lookup(struct process *p, int fd)
 {
-    struct list *fd_table = &thread_current()->fd_table;
-    ASSERT(fd_table != NULL);
+    struct list *fd_table = &p->fd_table;
+    ASSERT(lock_held_by_current_thread(&p->lock));
     ASSERT(fd > 1);
     if (list_empty(fd_table))
         return NULL;
@@ -88,6 +96,17 @@ struct file_descriptor *find_file_descriptor(int fd)
     return NULL;
 }
 
+struct file_descriptor *find_file_descriptor(int fd)
+{
+    struct process *p = thread_current()->proc->leader;
+    struct file_descriptor *file_descriptor;
+
+    lock_acquire(&p->lock);
+    file_descriptor = fd_lookup(p, fd);
+    lock_release(&p->lock);
+    return file_descriptor;
+}
+
 /* An open file. */
 struct file
 {
@@ -96,6 +115,162 @@ struct file
     bool deny_write;     /* Has file_deny_write() been called? */
 };
 
+/* Futexes.
+
+   A futex is any aligned int in user memory.  futex_wait() blocks
+   only if the int still holds the value the caller last saw, and
+   futex_wake() wakes threads blocked on it; user code does the
+   uncontended work with atomic instructions and calls in only to
+   sleep or to wake a sleeper (see lib/user/synch.c).
+
+   Waiters are kept in a fixed hash table keyed by the waiting
+   process and the user address of the int.  Futexes are private
+   to a process, whose threads all share one address space, so the
+   key does not depend on which frame holds the int: the page may
+   be evicted, or moved by a copy-on-write break, while threads
+   wait on it, and a forked child that still shares the frame with
+   its parent has futexes of its own.  A bucket's lock makes
+   checking the value and queueing the waiter atomic with respect
+   to wakers. */
+#define FUTEX_BUCKETS 64
+
+struct futex_bucket
+{
+    struct lock lock;     /* Protects waiters. */
+    struct list waiters;  /* struct futex_waiter, in arrival order. */
+};
+
+struct futex_key
+{
+    struct process *leader;   /* Process the futex belongs to. */
+    int *addr;                /* User address of the int. */
+};
+
+struct futex_waiter
+{
+    struct futex_key key;     /* Futex waited on. */
+    struct semaphore sema;    /* Upped by futex_wake(). */
+    struct list_elem elem;    /* Element of the bucket's waiters. */
+};
+
+static struct futex_bucket futex_table[FUTEX_BUCKETS];
+
+/* Returns the key of the futex at user address ADDR.  Kills the
+   process if ADDR is not an aligned int in its address space. */
+static struct futex_key futex_key(int *addr)
+{
+    struct thread *t = thread_current();
+    struct futex_key key;
+
+    if (addr == NULL || !is_user_vaddr(addr) || (uintptr_t)addr % sizeof *addr != 0)
+        exit(-1);
+#ifdef VM
+    if (spt_find_page(thread_spt(t), addr) == NULL)
+        exit(-1);
+#else
+    if (pml4_get_page(t->pml4, addr) == NULL)
+        exit(-1);
+#endif
+    key.leader = t->proc->leader;
+    key.addr = addr;
+    return key;
+}
+
+static bool futex_key_equal(const struct futex_key *a, const struct futex_key *b)
+{
+    return a->leader == b->leader && a->addr == b->addr;
+}
+
+static struct futex_bucket *futex_bucket(const struct futex_key *key)
+{
+    return &futex_table[hash_bytes(key, sizeof *key) % FUTEX_BUCKETS];
+}
+
+/* Blocks until futex_wake() is called on ADDR, provided *ADDR is
+   still EXPECTED.  Returns 0 after being woken, or -1 right away
+   if *ADDR has changed. */
+int futex_wait(int *addr, int expected)
+{
+    struct futex_waiter w;
+    struct futex_bucket *b;
+
+    w.key = futex_key(addr);
+    b = futex_bucket(&w.key);
+    lock_acquire(&b->lock);
+    /* process_exit_group() marks the process dying before
+       futex_kill() takes any bucket lock, so either we see the
+       mark here or futex_kill() finds us queued below. */
+    if (process_dying())
+    {
+        lock_release(&b->lock);
+        return -1;
+    }
+    /* Read through the user mapping, so that a page evicted in
+       the meantime is simply faulted back in. */
+    if (*(volatile int *)addr != expected)
+    {
+        lock_release(&b->lock);
+        return -1;
+    }
+    sema_init(&w.sema, 0);
+    list_push_back(&b->waiters, &w.elem);
+    lock_release(&b->lock);
+
+    sema_down(&w.sema);
+    return 0;
+}
+
+/* Wakes up to N threads waiting on ADDR, oldest first.  Returns
+   the number of threads woken. */
+int futex_wake(int *addr, int n)
+{
+    struct futex_key key = futex_key(addr);
+    struct futex_bucket *b = futex_bucket(&key);
+    struct list_elem *e;
+    int woken = 0;
+
+    lock_acquire(&b->lock);
+    for (e = list_begin(&b->waiters); e != list_end(&b->waiters) && woken < n;)
+    {
+        struct futex_waiter *w = list_entry(e, struct futex_waiter, elem);
+
+        e = list_next(e);
+        if (futex_key_equal(&w->key, &key))
+        {
+            list_remove(&w->elem);
+            sema_up(&w->sema);
+            woken++;
+        }
+    }
+    lock_release(&b->lock);
+    return woken;
+}
+
+/* Wakes every thread of LEADER's process that waits on a futex,
+   because the process is exiting. */
+void futex_kill(struct process *leader)
+{
+    for (int i = 0; i < FUTEX_BUCKETS; i++)
+    {
+        struct futex_bucket *b = &futex_table[i];
+        struct list_elem *e;
+
+        lock_acquire(&b->lock);
+        for (e = list_begin(&b->waiters); e != list_end(&b->waiters);)
+        {
+            struct futex_waiter *w = list_entry(e, struct futex_waiter, elem);
+
+            e = list_next(e);
+            if (w->key.leader == leader)
+            {
+                list_remove(&w->elem);
+                sema_up(&w->sema);
+            }
+        }
+        lock_release(&b->lock);
+    }
+}
+
 void syscall_init(void)
 {
     write_msr(MSR_STAR, ((uint64_t)SEL_UCSEG - 0x10) << 48 |
@@ -111,6 +286,11 @@ void syscall_init(void)
               FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
     lock_init(&filesys_lock);
+    for (int i = 0; i < FUTEX_BUCKETS; i++)
+    {
+        lock_init(&futex_table[i].lock);
+        list_init(&futex_table[i].waiters);
+    }
 }
 
 /* The main system call interface */
@@ -119,7 +299,9 @@ void syscall_handler(struct intr_frame *f)
     // TODO: Your implementation goes here.
 
     struct thread *t = thread_current();
+    struct intr_stats_scope scope;
     t->tf = *f;
+    intr_stats_enter(&scope, INTR_STAT_SYSCALL);
 #ifdef VM
     t->rsp_stack = f->rsp;
 #endif
@@ -213,9 +395,84 @@ void syscall_handler(struct intr_frame *f)
         munmap(f->R.rdi);
         break;
 
+    case SYS_UTHREAD_CREATE:
+        f->R.rax = process_uthread_create(f->R.rdi, f->R.rsi, f->R.rdx);
+        break;
+
+    case SYS_UTHREAD_JOIN:
+        f->R.rax = process_uthread_join(f->R.rdi);
+        break;
+
+    case SYS_UTHREAD_EXIT:
+        process_uthread_exit(f->R.rdi);
+        break;
+
+    case SYS_FUTEX_WAIT:
+        f->R.rax = futex_wait((int *)f->R.rdi, f->R.rsi);
+        break;
+
+    case SYS_FUTEX_WAKE:
+        f->R.rax = futex_wake((int *)f->R.rdi, f->R.rsi);
+        break;
+
+    case SYS_SCHED_TRACE:
+        thread_print_trace();
+        break;
+
+    case SYS_INTR_STATS:
+        f->R.rax = intr_stats(f->R.rdi, (struct intr_stats *)f->R.rsi);
+        break;
+
     default:
         break;
     }
+    intr_stats_exit(&scope);
+
+    /* Another thread ended the process while we were in here. */
+    if (process_dying())
+        thread_exit();
+}
+
+/* Kills the process unless all of [UADDR, UADDR + SIZE) lies in
+   pages of its address space that it may write.  SIZE must not be
+   0. */
+static void check_user_writable(void *uaddr, size_t size)
+{
+    struct thread *t = thread_current();
+    uint8_t *start = uaddr;
+    uint8_t *last = start + size - 1;
+    uint8_t *p;
+
+    if (start == NULL || last < start || !is_user_vaddr(start) || !is_user_vaddr(last))
+        exit(-1);
+    for (p = pg_round_down(start); p <= last; p += PGSIZE)
+    {
+#ifdef VM
+        struct page *page = spt_find_page(thread_spt(t), p);
+
+        if (page == NULL || !page->writable)
+            exit(-1);
+#else
+        uint64_t *pte = pml4e_walk(t->pml4, (uint64_t)p, false);
+
+        if (pte == NULL || (*pte & PTE_P) == 0 || !is_writable(pte))
+            exit(-1);
+#endif
+    }
+}
+
+/* Copies the latency statistics of interrupt vector VEC, or of
+   system calls if VEC is INTR_STAT_SYSCALL, to STATS.  Returns
+   false if VEC is out of range. */
+bool intr_stats(int vec, struct intr_stats *stats)
+{
+    struct intr_stats s;
+
+    check_user_writable(stats, sizeof *stats);
+    if (!intr_get_stats(vec, &s))
+        return false;
+    *stats = s;
+    return true;
 }
 
 // 핀토스 종료
@@ -225,10 +482,11 @@ void halt(void)
 }
 
 // 현재 유저 프로그램 종료 (status를 반환함)
+/* Ends the process.  See process_exit_group() for how its other
+   threads end. */
 void exit(int status)
 {
-    thread_current()->exit_status = status;
-    thread_exit();
+    process_exit_group(status);
 }
 
 tid_t fork(const char *thread_name, struct intr_frame *f)
@@ -297,7 +555,7 @@ bool remove(const char *file)
 // fd반환
 int open(const char *file)
 {
-    if (thread_current()->last_created_fd >= 126)
+    if (thread_current()->proc->leader->last_created_fd >= 126)
     {
         exit(126);
     }
@@ -324,12 +582,18 @@ int open(const char *file)
 
 void close(int fd)
 {
-
-    struct file_descriptor *close_fd = find_file_descriptor(fd);
+    struct process *p = thread_current()->proc->leader;
+
+    /* Unlink it first, so that another thread of this process cannot
+       close it at the same time. */
+    lock_acquire(&p->lock);
+    struct file_descriptor *close_fd = fd > 1 ? fd_lookup(p, fd) : NULL;
+    if (close_fd != NULL)
+        list_remove(&close_fd->fd_elem);
+    lock_release(&p->lock);
     if (close_fd == NULL)
         return -1;
     file_close(close_fd->file);
-    list_remove(&close_fd->fd_elem);
     free(close_fd);
 }
 
@@ -345,7 +609,7 @@ int read(int fd, void *buffer, unsigned size)
 {
     if (buffer == NULL || fd < 0 || !is_user_vaddr(buffer))
         exit(-1);
-    struct page *p = spt_find_page(&thread_current()->spt, buffer);
+    struct page *p = spt_find_page(thread_spt(thread_current()), buffer);
 
     off_t buff_size;
     if (fd == 0)
@@ -376,7 +640,7 @@ int write(int fd, const void *buffer, unsigned size)
 {
     if (buffer == NULL || !is_user_vaddr(buffer) || fd < 0)
         exit(-1);
-    struct page *p = spt_find_page(&thread_current()->spt, buffer);
+    struct page *p = spt_find_page(thread_spt(thread_current()), buffer);
     if (p == NULL)
         exit(-1);
     if (fd == 1)
@@ -417,15 +681,17 @@ unsigned tell(int fd)
 
 int process_add_file(struct file *f)
 {
-    struct thread *curr = thread_current();
+    struct process *p = thread_current()->proc->leader;
     struct file_descriptor *new_fd = malloc(sizeof(struct file_descriptor));
 
     // curr에 있는 fd_table의 fd를 확인하기 위한 작업
 
-    curr->last_created_fd += 1;
-    new_fd->fd = curr->last_created_fd;
+    lock_acquire(&p->lock);
+    p->last_created_fd += 1;
+    new_fd->fd = p->last_created_fd;
     new_fd->file = f;
-    list_push_back(&curr->fd_table, &new_fd->fd_elem);
+    list_push_back(&p->fd_table, &new_fd->fd_elem);
+    lock_release(&p->lock);
 
     return new_fd->fd;
 }
@@ -445,7 +711,7 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
     }
     // 매핑하려는 페이지가 이미 존재하는 페이지와 겹칠 때(==SPT에 존재하는 페이지일 때)
 
-    if (spt_find_page(&thread_current()->spt, addr))
+    if (spt_find_page(thread_spt(thread_current()), addr))
     {
         return NULL;
     }
@@ -1,22 +1,22 @@
 /* anon.c: Implementation of page for non-disk image (a.k.a. anonymous page). */
 
 #include "vm/vm.h"
+#include <bitmap.h>
 #include "devices/disk.h"
 #include "threads/vaddr.h"
 #include "threads/malloc.h"
 #include "threads/synch.h"
 #include "threads/mmu.h"
 
+/* Number of disk sectors in one swap slot, which holds one page. */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
-static struct hash swap_table;
 static bool anon_swap_in(struct page *page, void *kva);
 static bool anon_swap_out(struct page *page);
 static void anon_destroy(struct page *page);
 
-unsigned anon_page_hash(const struct hash_elem *p_, void *aux UNUSED);
-bool anon_page_less(const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED);
-
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
     .swap_in = anon_swap_in,
@@ -25,27 +25,31 @@ static const struct page_operations anon_ops = {
     .type = VM_ANON,
 };
 
+/* Swap slots in use, one bit per slot.  A swapped-out page
+   records its slot in anon_page->slot_idx, so swap-in needs no
+   lookup. */
+static struct bitmap *swap_slots;
+
+/* Slot after the last one handed out.  The search for a free
+   slot starts here (next fit), so it rarely rescans the run of
+   slots taken just before. */
+static size_t swap_hint;
+
+/* Protects swap_slots and swap_hint. */
 static struct lock swap_lock;
 
 /* Initialize the data for anonymous pages */
 void vm_anon_init(void)
 {
     /* TODO: Set up the swap_disk. */
-    hash_init(&swap_table, anon_page_hash, anon_page_less, NULL);
     lock_init(&swap_lock);
     swap_disk = disk_get(1, 1); // swap
+    if (swap_disk == NULL)
+        PANIC("no swap disk");
 
-    disk_sector_t swap_size = disk_size(swap_disk) / 8;
-    for (disk_sector_t i = 0; i < swap_size; i++)
-    {
-        struct slot *insert_disk = (struct slot *)malloc(sizeof(struct slot));
-        insert_disk->used = 0;
-        insert_disk->index = i;
-        insert_disk->page = NULL;
-        lock_acquire(&swap_lock);
-        hash_insert(&swap_table, &insert_disk->swap_elem);
-        lock_release(&swap_lock);
-    }
+    swap_slots = bitmap_create(disk_size(swap_disk) / SECTORS_PER_SLOT);
+    if (swap_slots == NULL)
+        PANIC("swap slot bitmap creation failed");
 }
 
 /* Initialize the file mapping */
@@ -61,69 +65,81 @@ bool anon_initializer(struct page *page, enum vm_type type, void *kva)
     return true;
 }
 
+/* Takes a free swap slot and returns its index. */
+static size_t
+swap_slot_alloc(void)
+{
+    size_t idx;
+
+    lock_acquire(&swap_lock);
+    idx = bitmap_scan_and_flip(swap_slots, swap_hint, 1, false);
+    if (idx == BITMAP_ERROR)
+        idx = bitmap_scan_and_flip(swap_slots, 0, 1, false);
+    if (idx == BITMAP_ERROR)
+        PANIC("full swap disk");
+    swap_hint = idx + 1;
+    lock_release(&swap_lock);
+    return idx;
+}
+
+/* Gives swap slot IDX back. */
+static void
+swap_slot_free(size_t idx)
+{
+    lock_acquire(&swap_lock);
+    ASSERT(bitmap_test(swap_slots, idx));
+    bitmap_reset(swap_slots, idx);
+    lock_release(&swap_lock);
+}
+
 /* Swap in the page by read contents from the swap disk. */
 static bool
 anon_swap_in(struct page *page, void *kva)
 {
     struct anon_page *anon_page = &page->anon;
-    struct slot *slot;
-    disk_sector_t page_slot_index = anon_page->slot_idx;
+    int idx = anon_page->slot_idx;
 
-    struct hash_iterator i;
-    hash_first(&i, &swap_table);
-    lock_acquire(&swap_lock);
-    while (hash_next(&i))
-    {
-        slot = hash_entry(hash_cur(&i), struct slot, swap_elem);
-        if (slot->index == page_slot_index)
-        {
-            for (int i = 0; i < 8; i++)
-                disk_read(swap_disk, page_slot_index * 8 + i, kva + DISK_SECTOR_SIZE * i);
-
-            slot->page = NULL;
-            slot->used = 0;
-            anon_page->slot_idx = -1;
-            lock_release(&swap_lock);
-            return true;
-        }
-    }
-    lock_release(&swap_lock);
-    return false;
+    if (idx < 0)
+        return false;
+    for (int i = 0; i < SECTORS_PER_SLOT; i++)
+        disk_read(swap_disk, idx * SECTORS_PER_SLOT + i, kva + DISK_SECTOR_SIZE * i);
+
+    swap_slot_free(idx);
+    anon_page->slot_idx = -1;
+    return true;
+}
+
+/* Reads the contents of PAGE, which is swapped out, into KVA
+   without giving up its swap slot. */
+void anon_swap_read(const struct page *page, void *kva)
+{
+    int idx = page->anon.slot_idx;
+
+    ASSERT(idx >= 0);
+    for (int i = 0; i < SECTORS_PER_SLOT; i++)
+        disk_read(swap_disk, idx * SECTORS_PER_SLOT + i, kva + DISK_SECTOR_SIZE * i);
 }
 
 /* Swap out the page by writing contents to the swap disk. */
+/* PAGE may belong to another process, so this goes through the
+   frame's kernel address and its owner's page table. */
 static bool
 anon_swap_out(struct page *page)
 {
     if (page == NULL)
         return false;
     struct anon_page *anon_page = &page->anon;
-    struct slot *slot;
-    struct hash_iterator i;
-    hash_first(&i, &swap_table);
-    lock_acquire(&swap_lock);
-    while (hash_next(&i))
-    {
-        slot = hash_entry(hash_cur(&i), struct slot, swap_elem);
-        if (slot->used == 0)
-        {
-            for (int i = 0; i < 8; i++)
-            {
-                disk_write(swap_disk, slot->index * 8 + i, page->va + DISK_SECTOR_SIZE * i);
-            }
-
-            anon_page->slot_idx = slot->index;
-            slot->page = page;
-            slot->used = 1;
-            page->frame->page = NULL;
-            page->frame = NULL;
-            pml4_clear_page(thread_current()->pml4, page->va);
-            lock_release(&swap_lock);
-            return true;
-        }
-    }
-    lock_release(&swap_lock);
-    PANIC("full swap disk");
+    struct frame *frame = page->frame;
+    size_t idx = swap_slot_alloc();
+
+    pml4_clear_page(frame->owner->pml4, page->va);
+    for (int i = 0; i < SECTORS_PER_SLOT; i++)
+        disk_write(swap_disk, idx * SECTORS_PER_SLOT + i, frame->kva + DISK_SECTOR_SIZE * i);
+
+    anon_page->slot_idx = idx;
+    frame->page = NULL;
+    page->frame = NULL;
+    return true;
 }
 
 /* Destroy the anonymous page. PAGE will be freed by the caller. */
@@ -131,18 +147,12 @@ static void
 anon_destroy(struct page *page)
 {
     struct anon_page *anon_page = &page->anon;
-}
 
-unsigned anon_page_hash(const struct hash_elem *p_, void *aux UNUSED)
-{
-    const struct slot *p = hash_entry(p_, struct slot, swap_elem);
-    return hash_bytes(&p->index, sizeof p->index);
-}
-
-bool anon_page_less(const struct hash_elem *a_, const struct hash_elem *b_, void *aux UNUSED)
-{
-    const struct slot *a = hash_entry(a_, struct slot, swap_elem);
-    const struct slot *b = hash_entry(b_, struct slot, swap_elem);
-
-    return a->index < b->index;
+    /* A page that dies while swapped out still owns its slot. */
+    if (anon_page->slot_idx >= 0)
+    {
+        swap_slot_free(anon_page->slot_idx);
+        anon_page->slot_idx = -1;
+    }
+    vm_frame_release(page);
 }
@@ -74,17 +74,38 @@ file_backed_swap_out(struct page *page)
     }
     struct necessary_info *nec = file_page->aux;
     struct file *file = nec->file;
+    struct frame *frame = page->frame;
+    uint64_t *pml4 = frame->owner->pml4;
     lock_acquire(&file_lock);
-    if (pml4_is_dirty(thread_current()->pml4, page->va))
+    if (pml4_is_dirty(pml4, page->va))
     {
-        file_write_at(file, page->va, nec->read_byte, nec->ofs);
-        pml4_set_dirty(thread_current()->pml4, page->va, false);
+        file_write_at(file, frame->kva, nec->read_byte, nec->ofs);
+        pml4_set_dirty(pml4, page->va, false);
     }
-    pml4_clear_page(thread_current()->pml4, page->va);
+    pml4_clear_page(pml4, page->va);
     lock_release(&file_lock);
+    frame->page = NULL;
+    page->frame = NULL;
     return true;
 }
 
+/* Writes PAGE, which is resident and mapped by PML4, back to its
+   file if it is dirty, leaving it in place.  Evicting it later
+   then needs no write.  The dirty bit is cleared before the write,
+   so a store that races with it leaves the page dirty again. */
+void file_backed_clean(struct page *page, uint64_t *pml4)
+{
+    struct necessary_info *nec = page->file.aux;
+
+    lock_acquire(&file_lock);
+    if (pml4_is_dirty(pml4, page->va))
+    {
+        pml4_set_dirty(pml4, page->va, false);
+        file_write_at(nec->file, page->frame->kva, nec->read_byte, nec->ofs);
+    }
+    lock_release(&file_lock);
+}
+
 /* Destory the file backed page. PAGE will be freed by the caller. */
 static void
 file_backed_destroy(struct page *page)
@@ -98,7 +119,7 @@ file_backed_destroy(struct page *page)
         file_write_at(nec->file, page->va, nec->read_byte, nec->ofs);
         pml4_set_dirty(curr->pml4, page->va, 0);
     }
-    pml4_clear_page(curr->pml4, page->va);
+    vm_frame_release(page);
 }
 
 /* Do the mmap */
@@ -149,7 +170,7 @@ void do_munmap(void *addr)
     while (true)
     {
         struct thread *curr = thread_current();
-        struct page *find_page = spt_find_page(&curr->spt, addr);
+        struct page *find_page = spt_find_page(thread_spt(curr), addr);
 
         if (find_page == NULL)
         {
@@ -158,7 +179,10 @@ void do_munmap(void *addr)
 
         struct necessary_info *nec = (struct necessary_info *)find_page->uninit.aux;
         find_page->file.aux = nec;
+        /* Keeps the frame from being evicted under us. */
+        lock_acquire(&thread_spt(curr)->claim_lock);
         file_backed_destroy(find_page);
+        lock_release(&thread_spt(curr)->claim_lock);
 
         addr += PGSIZE;
     }
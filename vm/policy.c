@@ -0,0 +1,210 @@
+/* policy.c: Page replacement policies. */
+
+#include "vm/policy.h"
+#include <string.h>
+#include "vm/vm.h"
+
+/* Frame table, for the policies that sweep it. */
+static struct frame *frames;
+static size_t frame_cnt;
+
+/* Entry the clock hand points at; kept between evictions. */
+static size_t clock_hand;
+
+static void
+table_init(struct frame *table, size_t cnt)
+{
+    frames = table;
+    frame_cnt = cnt;
+    clock_hand = 0;
+}
+
+/* Returns the frame under the clock hand and advances the hand. */
+static struct frame *
+clock_next(void)
+{
+    struct frame *f = &frames[clock_hand];
+
+    clock_hand = (clock_hand + 1) % frame_cnt;
+    return f;
+}
+
+static void
+table_insert(struct frame *f UNUSED)
+{
+}
+
+static void
+table_remove(struct frame *f UNUSED)
+{
+}
+
+/* CLOCK: the hand passes over frames used since it last went by,
+   clearing their accessed bits.  The first sweep may do nothing
+   else, so two are enough. */
+static struct frame *
+clock_victim(void)
+{
+    size_t n;
+
+    for (n = 0; n < 2 * frame_cnt; n++)
+    {
+        struct frame *f = clock_next();
+        if (frame_evictable(f) && !frame_accessed(f, true))
+            return f;
+    }
+    return NULL;
+}
+
+/* Second chance with dirty preference (enhanced CLOCK).  Frames
+   neither accessed nor dirty go first, since evicting them writes
+   nothing; then frames not accessed but dirty.  A round is one
+   sweep with no side effects looking for the former, then one
+   that clears accessed bits looking for the latter.  After one
+   round every accessed bit is clear, so two rounds are enough. */
+static struct frame *
+clock_dirty_victim(void)
+{
+    int round;
+    size_t n;
+
+    for (round = 0; round < 2; round++)
+    {
+        for (n = 0; n < frame_cnt; n++)
+        {
+            struct frame *f = clock_next();
+            if (frame_evictable(f) && !frame_accessed(f, false) && !frame_dirty(f))
+                return f;
+        }
+        for (n = 0; n < frame_cnt; n++)
+        {
+            struct frame *f = clock_next();
+            if (frame_evictable(f) && !frame_accessed(f, true))
+                return f;
+        }
+    }
+    return NULL;
+}
+
+/* 2Q (Johnson and Shasha, simplified).  A page loaded for the first
+   time enters A1in, a FIFO, and is evicted from there without regard
+   to how often it was used meanwhile, so a one-time scan cannot push
+   out the working set.  A1out remembers the pages that left A1in
+   most recently; one of those that is loaded again has proved itself
+   and enters Am, which is run as a clock.
+
+   A1out holds no entries of its own.  A page that leaves A1in is
+   stamped with the number of pages that have left A1in so far, and
+   it is still in A1out if fewer than A1OUT_MAX have left since. */
+enum
+{
+    Q_A1IN,
+    Q_AM
+};
+
+static struct list a1in, am;
+static size_t a1in_cnt, am_cnt;
+static size_t a1in_max;  /* A1in target: a quarter of the frames. */
+static size_t a1out_max; /* A1out size: half of the frames. */
+static uint64_t a1in_leaves;
+
+static void
+twoq_init(struct frame *table, size_t cnt)
+{
+    table_init(table, cnt);
+    list_init(&a1in);
+    list_init(&am);
+    a1in_max = cnt / 4 > 0 ? cnt / 4 : 1;
+    a1out_max = cnt / 2;
+}
+
+static void
+twoq_insert(struct frame *f)
+{
+    struct page *page = f->page;
+
+    if (page->policy_seq != 0 && a1in_leaves - page->policy_seq < a1out_max)
+    {
+        f->policy_queue = Q_AM;
+        list_push_back(&am, &f->policy_elem);
+        am_cnt++;
+    }
+    else
+    {
+        f->policy_queue = Q_A1IN;
+        list_push_back(&a1in, &f->policy_elem);
+        a1in_cnt++;
+    }
+}
+
+static void
+twoq_remove(struct frame *f)
+{
+    list_remove(&f->policy_elem);
+    if (f->policy_queue == Q_AM)
+        am_cnt--;
+    else
+    {
+        a1in_cnt--;
+        f->page->policy_seq = ++a1in_leaves;
+    }
+}
+
+/* Goes through up to CNT frames of Q from the front, moving each one
+   to the back.  With USE_ACCESSED, frames accessed since they were
+   last looked at are passed over.  Returns the first evictable frame
+   found, or NULL. */
+static struct frame *
+queue_scan(struct list *q, size_t cnt, bool use_accessed)
+{
+    size_t n;
+
+    for (n = 0; n < cnt && !list_empty(q); n++)
+    {
+        struct list_elem *e = list_pop_front(q);
+        struct frame *f = list_entry(e, struct frame, policy_elem);
+
+        list_push_back(q, e);
+        if (!frame_evictable(f))
+            continue;
+        if (use_accessed && frame_accessed(f, true))
+            continue;
+        return f;
+    }
+    return NULL;
+}
+
+static struct frame *
+twoq_victim(void)
+{
+    struct frame *f = NULL;
+
+    if (a1in_cnt > a1in_max || am_cnt == 0)
+        f = queue_scan(&a1in, a1in_cnt, false);
+    if (f == NULL)
+        f = queue_scan(&am, 2 * am_cnt, true);
+    if (f == NULL)
+        f = queue_scan(&a1in, a1in_cnt, false);
+    return f;
+}
+
+static const struct frame_policy policies[] = {
+    {"clock", table_init, table_insert, table_remove, clock_victim},
+    {"clock-dirty", table_init, table_insert, table_remove, clock_dirty_victim},
+    {"2q", twoq_init, twoq_insert, twoq_remove, twoq_victim},
+};
+
+/* Policy in use; chosen with the -vm-policy kernel option. */
+const struct frame_policy *frame_policy = &policies[0];
+
+/* Returns the policy called NAME, or NULL if there is none. */
+const struct frame_policy *
+frame_policy_find(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof policies / sizeof *policies; i++)
+        if (!strcmp(policies[i].name, name))
+            return &policies[i];
+    return NULL;
+}
@@ -1,21 +1,76 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
+#include <stdio.h>
 #include "threads/malloc.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
 #include "vm/uninit.h"
 #include "vm/anon.h"
+#include "vm/policy.h"
 #include "threads/vaddr.h"
 #include "threads/pte.h"
 #include "threads/mmu.h"
 #include "kernel/list.h"
 #include "lib/string.h"
+#include "intrinsic.h"
 
 static uint64_t cur_stack_size = PGSIZE;
 static uint64_t limit_stack_size = (1 << 20);
 
-struct list frame_table;
-struct list empty_frame_list;
+/* Frame table: one entry per user pool page, shared by all
+   processes.  vm_lock guards the entries. */
+static struct frame *frame_table;
+static size_t frame_cnt;
+static size_t frames_usable; /* # of user pool pages that can be handed out. */
+static size_t frames_used;   /* # of those in use. */
+
+/* Background reclaim.  kswapd is woken when fewer than kswapd_low
+   frames are free and evicts pages until kswapd_high are, so that
+   page faults normally find a free frame instead of evicting. */
+static size_t kswapd_low, kswapd_high;
+bool vm_kswapd = true;               /* Run kswapd at all?  See -no-kswapd. */
+static struct semaphore kswapd_sema;
+static bool kswapd_busy;             /* Woken and not done yet. */
+#define PRECLEAN_SCAN 256            /* Frames looked at per pre-clean pass. */
+#define PRECLEAN_BATCH 32            /* Frames written back per pre-clean pass. */
+
+/* Most processes whose claim_locks an eviction holds at once: the
+   frame's owner and the processes that share it since a fork.
+   Frames shared more widely are not evicted. */
+#define EVICT_LOCKS_MAX 8
+
+/* Claim locks taken for an eviction, to be released after it. */
+struct evict_locks
+{
+    struct lock *locks[EVICT_LOCKS_MAX];
+    size_t cnt;
+};
+
+/* Page fault latency histogram, in cycles.  Each power of two is
+   split into 1 << LAT_SUB_BITS buckets, so that a percentile read
+   from it is off by at most 1/8. */
+#define LAT_SUB_BITS 3
+#define LAT_BUCKETS (64 << LAT_SUB_BITS)
+static uint64_t fault_lat[LAT_BUCKETS];
+static uint64_t fault_lat_max;
+
+/* Statistics. */
+static uint64_t frame_allocs; /* # of frames taken from the user pool. */
+static uint64_t cow_shares;   /* # of pages shared with a child by fork. */
+static uint64_t cow_copies;   /* # of write faults that copied a frame. */
+static uint64_t cow_reuses;   /* # of write faults on a frame no longer shared. */
+static uint64_t page_faults;  /* # of page faults handled. */
+static uint64_t page_loads;   /* # of pages loaded into a frame. */
+static uint64_t evictions;    /* # of pages evicted. */
+static uint64_t dirty_evictions; /* # of those that were dirty. */
+static uint64_t shared_evictions; /* # of pages evicted along with a shared frame. */
+static uint64_t direct_reclaims; /* # of evictions done by a faulting thread. */
+static uint64_t kswapd_wakeups;  /* # of times kswapd was woken. */
+static uint64_t kswapd_reclaims; /* # of frames kswapd freed. */
+static uint64_t precleaned;      /* # of pages kswapd wrote back early. */
+
+static void kswapd(void *aux UNUSED);
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void vm_init(void)
@@ -29,9 +84,31 @@ void vm_init(void)
     /* DO NOT MODIFY UPPER LINES. */
     /* TODO: Your code goes here. */
 
-    list_init(&frame_table);
-    list_init(&empty_frame_list);
     lock_init(&vm_lock);
+    frame_cnt = palloc_user_page_cnt();
+    frame_table = calloc(frame_cnt, sizeof *frame_table);
+    if (frame_table == NULL)
+        PANIC("frame table allocation failed");
+    frame_policy->init(frame_table, frame_cnt);
+
+    frames_usable = palloc_user_free_cnt();
+    kswapd_low = frames_usable / 64 + 4;
+    kswapd_high = 2 * kswapd_low;
+    sema_init(&kswapd_sema, 0);
+    if (vm_kswapd && thread_create("kswapd", PRI_DEFAULT, kswapd, NULL) == TID_ERROR)
+        PANIC("cannot start kswapd");
+}
+
+/* Selects the page replacement policy called NAME.  Returns false
+   if there is no such policy. */
+bool vm_set_policy(const char *name)
+{
+    const struct frame_policy *policy = frame_policy_find(name);
+
+    if (policy == NULL)
+        return false;
+    frame_policy = policy;
+    return true;
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -51,9 +128,20 @@ page_get_type(struct page *page)
 }
 
 /* Helpers */
-static struct frame *vm_get_victim(void);
+static struct frame *vm_get_victim(struct evict_locks *);
 static bool vm_do_claim_page(struct page *page);
+static bool vm_claim_page_locked(struct supplemental_page_table *spt, struct page *page);
 static struct frame *vm_evict_frame(void);
+static struct frame *frame_detach(struct page *page);
+static void frame_free(struct frame *frame);
+
+/* Returns the leader thread of the current process, which holds
+   its page table and supplemental page table. */
+static struct thread *
+current_leader(void)
+{
+    return thread_current()->proc->leader->thread;
+}
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or
@@ -64,7 +152,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 
     ASSERT(VM_TYPE(type) != VM_UNINIT)
 
-    struct supplemental_page_table *spt = &thread_current()->spt;
+    struct supplemental_page_table *spt = thread_spt(thread_current());
 
     /* Check wheter the upage is already occupied or not. */
     if (spt_find_page(spt, upage) == NULL)
@@ -95,20 +183,19 @@ err:
 struct page *
 spt_find_page(struct supplemental_page_table *spt, void *va)
 {
-    struct page *page = NULL;
+    struct page key;
     /* TODO: Fill this function. */
     struct hash *hash = &spt->hash_table;
 
-    page = (struct page *)malloc(sizeof(struct page));
-    page->va = pg_round_down(va);
-    struct hash_elem *e = hash_find(hash, &page->h_elem);
-    free(page);
+    key.va = pg_round_down(va);
+    rwlock_acquire_read(&spt->lock);
+    struct hash_elem *e = hash_find(hash, &key.h_elem);
+    rwlock_release_read(&spt->lock);
     if (e == NULL)
     {
         return NULL;
     }
-    page = hash_entry(e, struct page, h_elem);
-    return page;
+    return hash_entry(e, struct page, h_elem);
 }
 
 /* Insert PAGE into spt with validation. */
@@ -119,109 +206,338 @@ bool spt_insert_page(struct supplemental_page_table *spt UNUSED,
     /* TODO: Fill this function. */
     struct hash *hash = &spt->hash_table;
 
-    if (hash_insert(hash, &page->h_elem) != NULL)
-    {
-        return succ;
-    }
-
-    succ = true;
+    rwlock_acquire_write(&spt->lock);
+    succ = hash_insert(hash, &page->h_elem) == NULL;
+    rwlock_release_write(&spt->lock);
     return succ;
 }
 
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
 {
+    rwlock_acquire_write(&spt->lock);
     hash_delete(&spt->hash_table, &page->h_elem);
+    rwlock_release_write(&spt->lock);
     vm_dealloc_page(page);
     return true;
 }
 
-/* Get the struct frame, that will be evicted. */
-static struct frame *
-vm_get_victim(void)
+/* Returns true if F holds a page that may be evicted: one that is
+   not being filled or evicted.  vm_lock must be held. */
+bool frame_evictable(struct frame *f)
 {
-    struct frame *victim = NULL;
-    /* TODO: The policy for eviction is up to you. */
+    return f->kva != NULL && f->page != NULL && !f->pinned;
+}
 
-    /* FIFO */
-    // lock_acquire(&vm_lock);
-    // struct list_elem *e = list_pop_front(&frame_table);
-    // lock_release(&vm_lock);
-    // victim = list_entry(e, struct frame, f_elem);
+/* Returns true if PAGE, mapped by LEADER's process, was accessed
+   since its accessed bit was last cleared, clearing it if CLEAR. */
+static bool
+page_accessed(struct thread *leader, struct page *page, bool clear)
+{
+    bool accessed = pml4_is_accessed(leader->pml4, page->va);
 
-    /* Clock Algorithm */
+    if (accessed && clear)
+        pml4_set_accessed(leader->pml4, page->va, false);
+    return accessed;
+}
 
+/* Returns true if F was accessed through any of the pages that map
+   it since its accessed bits were last cleared, clearing them if
+   CLEAR.  The bits are read from the page tables of the owner and
+   the sharers, whichever process is running.  vm_lock must be
+   held. */
+bool frame_accessed(struct frame *f, bool clear)
+{
+    bool accessed = page_accessed(f->owner, f->page, clear);
     struct list_elem *e;
+
+    for (e = list_begin(&f->sharers); e != list_end(&f->sharers); e = list_next(e))
+    {
+        struct page *p = list_entry(e, struct page, share_elem);
+
+        if (page_accessed(p->sharer, p, clear))
+            accessed = true;
+    }
+    return accessed;
+}
+
+/* Returns true if F's page was written since it was loaded. */
+bool frame_dirty(const struct frame *f)
+{
+    return pml4_is_dirty(f->owner->pml4, f->page->va);
+}
+
+/* Tries to take CLAIM, LEADER's claim_lock, for an eviction and
+   records it in EL.  A lock the faulting thread already holds for
+   its own process, or its parent's during fork, is neither taken
+   nor recorded. */
+static bool
+evict_lock(struct evict_locks *el, struct lock *claim)
+{
+    if (lock_held_by_current_thread(claim))
+        return true;
+    if (el->cnt == EVICT_LOCKS_MAX || !lock_try_acquire(claim))
+        return false;
+    el->locks[el->cnt++] = claim;
+    return true;
+}
+
+/* Releases the claim locks recorded in EL. */
+static void
+evict_unlock(struct evict_locks *el)
+{
+    while (el->cnt > 0)
+        lock_release(el->locks[--el->cnt]);
+}
+
+/* Asks the replacement policy for victims.
+
+   The claim_locks of the owner and of every process sharing the
+   frame keep them from faulting it back in, breaking the sharing
+   or exiting while we write it out.  We only try to take them,
+   passing over frames whose processes are busy, and record the
+   ones taken in EL.  Returns the victim pinned and out of the
+   policy's hands, or NULL if no frame can be evicted. */
+static struct frame *
+vm_get_victim(struct evict_locks *el)
+{
+    struct frame *victim = NULL;
+    size_t n;
+
+    el->cnt = 0;
     lock_acquire(&vm_lock);
-    for (e = list_begin(&frame_table); e != list_end(&frame_table); e = list_next(e))
+    for (n = 0; n < frame_cnt && victim == NULL; n++)
     {
-        victim = list_entry(e, struct frame, f_elem);
-        if (victim->page == NULL)
+        struct frame *f = frame_policy->victim();
+        struct list_elem *e;
+
+        if (f == NULL)
+            break;
+        if (!evict_lock(el, &f->owner->spt.claim_lock))
+            continue;
+        for (e = list_begin(&f->sharers); e != list_end(&f->sharers); e = list_next(e))
         {
-            lock_release(&vm_lock);
-            return victim;
-        }
-        if (pml4_is_accessed(thread_current()->pml4, victim->page->va))
-            pml4_set_accessed(thread_current()->pml4, victim->page->va, 0);
+            struct page *p = list_entry(e, struct page, share_elem);
 
-        else
+            if (!evict_lock(el, &p->sharer->spt.claim_lock))
+                break;
+        }
+        if (e != list_end(&f->sharers))
         {
-            lock_release(&vm_lock);
-            return victim;
+            evict_unlock(el);
+            continue;
         }
+        frame_policy->remove(f);
+        f->pinned = true;
+        victim = f;
     }
     lock_release(&vm_lock);
     return victim;
 }
 
+/* Swaps out the pages that share VICTIM with its owner since a
+   fork, after the owner's own page.  All of them map it
+   read-only, so each gets its own copy of the same contents in
+   swap.  Sharers are only ever anonymous pages. */
+static void
+vm_evict_sharers(struct frame *victim)
+{
+    for (;;)
+    {
+        struct page *p = NULL;
+
+        lock_acquire(&vm_lock);
+        if (!list_empty(&victim->sharers))
+        {
+            p = list_entry(list_pop_front(&victim->sharers), struct page, share_elem);
+            victim->page = p;
+            victim->owner = p->sharer;
+        }
+        lock_release(&vm_lock);
+        if (p == NULL)
+            return;
+        if (!swap_out(p))
+            PANIC("cannot swap out a shared page");
+        shared_evictions++;
+    }
+}
+
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 static struct frame *
 vm_evict_frame(void)
 {
-    struct frame *victim UNUSED = vm_get_victim();
-    /* TODO: swap out the victim and return the evicted frame. */
-    if (swap_out(victim->page))
+    struct evict_locks el;
+    struct frame *victim = vm_get_victim(&el);
+
+    if (victim == NULL)
+        return NULL;
+    if (frame_dirty(victim))
+        dirty_evictions++;
+    if (!swap_out(victim->page))
     {
-        // list_push_back(&frame_table, &victim->f_elem); // FIFO
-        return victim;
+        lock_acquire(&vm_lock);
+        victim->pinned = false;
+        frame_policy->insert(victim);
+        lock_release(&vm_lock);
+        victim = NULL;
     }
-
-    return NULL;
+    else
+    {
+        vm_evict_sharers(victim);
+        evictions++;
+    }
+    evict_unlock(&el);
+    return victim;
 }
 
 /* palloc() and get frame. If there is no available page, evict the page
  * and return it. This always return valid address. That is, if the user pool
  * memory is full, this function evicts the frame to get the available memory
  * space.*/
+/* The frame comes back pinned; frame_install() links it to its
+ * page and makes it evictable. */
 static struct frame *
 vm_get_frame(void)
 {
     struct frame *frame = NULL;
     /* TODO: Fill this function. */
     void *kva;
-    struct page *page = NULL;
+
+    bool wake;
 
     kva = palloc_get_page(PAL_USER);
     if (kva == NULL)
     {
-        struct frame *victim = vm_evict_frame();
-        victim->page = NULL;
-        return victim;
+        /* kswapd fell behind. */
+        frame = vm_evict_frame();
+        if (frame == NULL)
+            PANIC("no user frame can be evicted");
+        direct_reclaims++;
+    }
+    else
+    {
+        frame = &frame_table[palloc_user_page_idx(kva)];
+        lock_acquire(&vm_lock);
+        frame->kva = kva;
+        frame->pinned = true;
+        list_init(&frame->sharers);
+        frames_used++;
+        lock_release(&vm_lock);
+        frame_allocs++;
     }
-
-    frame = (struct frame *)malloc(sizeof(struct frame));
-    frame->kva = kva;
-    frame->page = page;
 
     lock_acquire(&vm_lock);
-    list_push_back(&frame_table, &frame->f_elem);
+    wake = vm_kswapd && !kswapd_busy && frames_usable - frames_used < kswapd_low;
+    if (wake)
+        kswapd_busy = true;
     lock_release(&vm_lock);
+    if (wake)
+        sema_up(&kswapd_sema);
 
     ASSERT(frame != NULL);
     ASSERT(frame->page == NULL);
     return frame;
 }
 
+/* Links FRAME, from vm_get_frame(), with PAGE of the current
+   process and unpins it. */
+static void
+frame_install(struct frame *frame, struct page *page)
+{
+    lock_acquire(&vm_lock);
+    frame->page = page;
+    frame->owner = current_leader();
+    frame->pinned = false;
+    page->frame = frame;
+    frame_policy->insert(frame);
+    lock_release(&vm_lock);
+}
+
+/* Returns FRAME, which no page uses any more, to the user pool. */
+static void
+frame_free(struct frame *frame)
+{
+    void *kva = frame->kva;
+
+    lock_acquire(&vm_lock);
+    frame->kva = NULL;
+    frame->page = NULL;
+    frame->owner = NULL;
+    frame->pinned = false;
+    frames_used--;
+    lock_release(&vm_lock);
+    palloc_free_page(kva);
+}
+
+/* Writes back dirty file-backed pages past the ones looked at last
+   time, a batch at a time, so that evicting them later costs no
+   write.  Anonymous pages are not pre-cleaned: swap-in gives up
+   their swap slot, so evicting one always writes. */
+static void
+vm_preclean(void)
+{
+    static size_t cursor;
+    size_t n, cleaned = 0;
+
+    for (n = 0; n < PRECLEAN_SCAN && n < frame_cnt && cleaned < PRECLEAN_BATCH; n++)
+    {
+        struct frame *f;
+        struct page *page = NULL;
+        struct lock *claim = NULL;
+        uint64_t *pml4 = NULL;
+
+        lock_acquire(&vm_lock);
+        f = &frame_table[cursor];
+        cursor = (cursor + 1) % frame_cnt;
+        if (frame_evictable(f) && VM_TYPE(f->page->operations->type) == VM_FILE && frame_dirty(f) && lock_try_acquire(&f->owner->spt.claim_lock))
+        {
+            /* Pinned, it is not evicted or freed under us. */
+            f->pinned = true;
+            page = f->page;
+            claim = &f->owner->spt.claim_lock;
+            pml4 = f->owner->pml4;
+        }
+        lock_release(&vm_lock);
+        if (page == NULL)
+            continue;
+
+        file_backed_clean(page, pml4);
+        lock_acquire(&vm_lock);
+        f->pinned = false;
+        lock_release(&vm_lock);
+        lock_release(claim);
+        cleaned++;
+        precleaned++;
+    }
+}
+
+/* Background page reclaimer.  Evicts pages until kswapd_high
+   frames are free, then pre-cleans some, then sleeps until
+   vm_get_frame() sees free frames drop below kswapd_low. */
+static void
+kswapd(void *aux UNUSED)
+{
+    for (;;)
+    {
+        sema_down(&kswapd_sema);
+        kswapd_wakeups++;
+        while (frames_usable - frames_used < kswapd_high)
+        {
+            struct frame *f = vm_evict_frame();
+            /* Everything left is in use. */
+            if (f == NULL)
+                break;
+            frame_free(f);
+            kswapd_reclaims++;
+        }
+        vm_preclean();
+
+        lock_acquire(&vm_lock);
+        kswapd_busy = false;
+        lock_release(&vm_lock);
+    }
+}
+
 /* Growing the stack. */
 static void
 vm_stack_growth(void *addr)
@@ -230,20 +546,138 @@ vm_stack_growth(void *addr)
 }
 
 /* Handle the fault on write_protected page */
+/* PAGE is writable but mapped read-only because fork() shared its
+   frame.  Gives PAGE a copy of the frame, or, if nobody else maps
+   the frame any more, just makes the mapping writable. */
 static bool
-vm_handle_wp(struct page *page UNUSED)
+vm_handle_wp(struct page *page)
+{
+    struct thread *cur = thread_current();
+    struct supplemental_page_table *spt = thread_spt(cur);
+    struct frame *old, *new, *unused = NULL;
+    uint64_t *pte;
+    bool shared;
+
+    lock_acquire(&spt->claim_lock);
+
+    /* Another thread of this process may have fixed it already, or
+       the page may have been swapped out; either way the access
+       is retried. */
+    old = page->frame;
+    pte = pml4e_walk(cur->pml4, (uint64_t)page->va, 0);
+    if (old == NULL || pte == NULL || is_writable(pte))
+        goto done;
+
+    lock_acquire(&vm_lock);
+    shared = old->page != page || !list_empty(&old->sharers);
+    lock_release(&vm_lock);
+
+    if (shared)
+    {
+        new = vm_get_frame();
+        if (page->frame != old)
+        {
+            /* We evicted it ourselves to get NEW; the access
+               faults again and swaps it back in. */
+            unused = new;
+            goto done;
+        }
+        memcpy(new->kva, old->kva, PGSIZE);
+
+        lock_acquire(&vm_lock);
+        /* The others may have let go of OLD meanwhile. */
+        unused = frame_detach(page);
+        new->page = page;
+        new->owner = current_leader();
+        new->pinned = false;
+        page->frame = new;
+        frame_policy->insert(new);
+        lock_release(&vm_lock);
+        cow_copies++;
+    }
+    else
+        cow_reuses++;
+
+    pml4_set_page(cur->pml4, page->va, page->frame->kva, true);
+    invlpg((uint64_t)page->va);
+
+done:
+    lock_release(&spt->claim_lock);
+    if (unused != NULL)
+        frame_free(unused);
+    return true;
+}
+
+/* Returns the latency histogram bucket for CYCLES. */
+static size_t
+lat_bucket(uint64_t cycles)
 {
+    int msb;
+
+    if (cycles < (1 << LAT_SUB_BITS))
+        return cycles;
+    msb = 63 - __builtin_clzll(cycles);
+    return ((size_t)(msb - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + ((cycles >> (msb - LAT_SUB_BITS)) & ((1 << LAT_SUB_BITS) - 1));
 }
 
+/* Returns the largest latency that falls into bucket B. */
+static uint64_t
+lat_bucket_max(size_t b)
+{
+    int shift;
+
+    if (b < (1 << LAT_SUB_BITS))
+        return b;
+    shift = (b >> LAT_SUB_BITS) - 1;
+    return (((uint64_t)(1 << LAT_SUB_BITS) + (b & ((1 << LAT_SUB_BITS) - 1)) + 1) << shift) - 1;
+}
+
+/* Returns an upper bound on the PCT'th percentile fault latency. */
+static uint64_t
+fault_lat_percentile(int pct)
+{
+    uint64_t total = 0, sum = 0;
+    size_t b;
+
+    for (b = 0; b < LAT_BUCKETS; b++)
+        total += fault_lat[b];
+    for (b = 0; b < LAT_BUCKETS; b++)
+    {
+        sum += fault_lat[b];
+        if (total > 0 && sum * 100 >= total * pct)
+            return lat_bucket_max(b) < fault_lat_max ? lat_bucket_max(b) : fault_lat_max;
+    }
+    return 0;
+}
+
+static bool vm_handle_fault(struct intr_frame *f, void *addr, bool user,
+                            bool write, bool not_present);
+
 /* Return true on success */
+/* Times the handling of each fault for vm_print_stats(). */
 bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
                          bool user UNUSED, bool write UNUSED, bool not_present UNUSED)
 {
-    struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
+    uint64_t start = rdtsc();
+    bool success = vm_handle_fault(f, addr, user, write, not_present);
+    uint64_t cycles = rdtsc() - start;
+
+    fault_lat[lat_bucket(cycles)]++;
+    if (cycles > fault_lat_max)
+        fault_lat_max = cycles;
+    return success;
+}
+
+static bool
+vm_handle_fault(struct intr_frame *f, void *addr, bool user,
+                bool write, bool not_present)
+{
+    struct supplemental_page_table *spt UNUSED = thread_spt(thread_current());
     struct page *page = NULL;
     /* TODO: Validate the fault */
     /* TODO: Your code goes here */
 
+    page_faults++;
     if (is_kernel_vaddr(addr))
     {
         return false;
@@ -274,7 +708,16 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
         }
         if (write == 1 && page->writable == 0)
             return false;
-        return vm_do_claim_page(page);
+        return vm_claim_page_locked(spt, page);
+    }
+
+    /* A write to a present page that we mapped read-only. */
+    if (write)
+    {
+        page = spt_find_page(spt, addr);
+        if (page == NULL || !page->writable)
+            return false;
+        return vm_handle_wp(page);
     }
 
     return false;
@@ -293,35 +736,167 @@ bool vm_claim_page(void *va UNUSED)
 {
     struct page *page = NULL;
     /* TODO: Fill this function */
-    struct supplemental_page_table *spt = &thread_current()->spt;
+    struct supplemental_page_table *spt = thread_spt(thread_current());
 
     page = spt_find_page(spt, va);
     if (page == NULL)
         return false;
 
-    return vm_do_claim_page(page);
+    return vm_claim_page_locked(spt, page);
+}
+
+/* Claims PAGE of SPT unless another thread sharing SPT already
+   did so while we were finding it. */
+static bool vm_claim_page_locked(struct supplemental_page_table *spt, struct page *page)
+{
+    bool success = true;
+
+    lock_acquire(&spt->claim_lock);
+    if (pml4_get_page(thread_current()->pml4, page->va) == NULL)
+        success = vm_do_claim_page(page);
+    lock_release(&spt->claim_lock);
+    return success;
 }
 
 /* Claim the PAGE and set up the mmu. */
 static bool vm_do_claim_page(struct page *page)
 {
     struct frame *frame = vm_get_frame();
+    bool success;
 
     /* Set links */
-    frame->page = page;
     page->frame = frame;
+    frame->page = page;
 
-    /* TODO: Insert page table entry to map page's VA to frame's PA. */
+    /* Map the page only once it is filled: other threads of the
+       process may touch it meanwhile, and must fault and wait on
+       claim_lock instead of seeing the frame's old contents. */
+    success = swap_in(page, frame->kva);
+    if (success)
+    {
+        struct thread *cur = thread_current();
+        pml4_set_page(cur->pml4, page->va, frame->kva, page->writable);
+    }
+    frame_install(frame, page);
+    page_loads++;
+    return success;
+}
+
+/* Detaches PAGE from its frame.  Returns the frame if PAGE was the
+   last page using it, so that the caller can free it, or NULL if
+   the frame is still in use.  vm_lock must be held. */
+static struct frame *
+frame_detach(struct page *page)
+{
+    struct frame *frame = page->frame;
+
+    ASSERT(frame != NULL);
+    page->frame = NULL;
+    if (frame->page != page)
+    {
+        list_remove(&page->share_elem);
+        return NULL;
+    }
+    if (list_empty(&frame->sharers))
+    {
+        frame_policy->remove(frame);
+        frame->page = NULL;
+        return frame;
+    }
+    frame->page = list_entry(list_pop_front(&frame->sharers), struct page, share_elem);
+    frame->owner = frame->page->sharer;
+    return NULL;
+}
+
+/* Unmaps PAGE, which belongs to the current process, and frees its
+   frame unless pages of other processes still share it.  Called
+   when PAGE is destroyed. */
+void vm_frame_release(struct page *page)
+{
     struct thread *cur = thread_current();
-    pml4_set_page(cur->pml4, page->va, frame->kva, page->writable);
+    struct frame *frame;
 
-    return swap_in(page, frame->kva);
+    if (page->frame == NULL)
+        return;
+    if (cur->pml4 != NULL)
+        pml4_clear_page(cur->pml4, page->va);
+
+    lock_acquire(&vm_lock);
+    frame = frame_detach(page);
+    lock_release(&vm_lock);
+
+    if (frame != NULL)
+        frame_free(frame);
+}
+
+/* Returns the page table of the thread that SPT is embedded in. */
+static uint64_t *
+spt_pml4(struct supplemental_page_table *spt)
+{
+    return ((struct thread *)((uint8_t *)spt - offsetof(struct thread, spt)))->pml4;
+}
+
+/* Makes DST, a new page of the current (child) process, share the
+   frame of SRC, a resident anonymous page of the process whose
+   page table is SRC_PML4.  Both end up mapped read-only, so the
+   first write to either faults into vm_handle_wp(). */
+static bool
+cow_share(uint64_t *src_pml4, struct page *src, struct page *dst)
+{
+    struct frame *frame;
+
+    lock_acquire(&vm_lock);
+    frame = src->frame;
+    if (frame != NULL)
+    {
+        dst->frame = frame;
+        dst->sharer = current_leader();
+        list_push_back(&frame->sharers, &dst->share_elem);
+    }
+    lock_release(&vm_lock);
+    /* Swapped out meanwhile: the caller copies from swap instead. */
+    if (frame == NULL)
+        return false;
+
+    /* Turns DST from uninit into anon; FRAME's contents are left
+       alone. */
+    swap_in(dst, frame->kva);
+    pml4_set_page(thread_current()->pml4, dst->va, frame->kva, false);
+    if (src->writable)
+        pml4_set_page(src_pml4, src->va, frame->kva, false);
+    cow_shares++;
+    return true;
+}
+
+/* Prints virtual memory statistics. */
+void vm_print_stats(void)
+{
+    printf("VM: %llu frames allocated, %llu pages shared by fork, "
+           "%llu copied and %llu reused on write\n",
+           (unsigned long long)frame_allocs, (unsigned long long)cow_shares,
+           (unsigned long long)cow_copies, (unsigned long long)cow_reuses);
+    printf("VM: %s replacement: %llu page faults, %llu pages loaded, "
+           "%llu evicted (%llu dirty, %llu more pages sharing them)\n",
+           frame_policy->name, (unsigned long long)page_faults,
+           (unsigned long long)page_loads, (unsigned long long)evictions,
+           (unsigned long long)dirty_evictions, (unsigned long long)shared_evictions);
+    printf("VM: kswapd freed %llu frames in %llu wakeups and wrote back "
+           "%llu pages early; %llu evictions by faulting threads\n",
+           (unsigned long long)kswapd_reclaims, (unsigned long long)kswapd_wakeups,
+           (unsigned long long)precleaned, (unsigned long long)direct_reclaims);
+    printf("VM: fault latency p50 %llu, p90 %llu, p99 %llu, max %llu cycles\n",
+           (unsigned long long)fault_lat_percentile(50),
+           (unsigned long long)fault_lat_percentile(90),
+           (unsigned long long)fault_lat_percentile(99),
+           (unsigned long long)fault_lat_max);
 }
 
 /* Initialize new supplemental page table */
 void supplemental_page_table_init(struct supplemental_page_table *spt UNUSED)
 {
     hash_init(&spt->hash_table, page_hash, page_less, NULL);
+    rwlock_init(&spt->lock);
+    lock_init(&spt->claim_lock);
 }
 
 /* Copy supplemental page table from src to dst */
@@ -332,33 +907,52 @@ bool supplemental_page_table_copy(struct supplemental_page_table *dst UNUSED,
     struct hash *dst_hash = &dst->hash_table;
     struct hash_iterator i;
 
+    bool success = false;
+    uint64_t *src_pml4 = spt_pml4(src);
+
+    /* Threads sharing SRC may add pages while we walk it.  Its
+       claim_lock keeps its frames from being evicted meanwhile. */
+    rwlock_acquire_read(&src->lock);
+    lock_acquire(&src->claim_lock);
     hash_first(&i, src_hash);
     while (hash_next(&i))
     {
         struct page *p = hash_entry(hash_cur(&i), struct page, h_elem);
         if (p == NULL)
-            return false;
+            goto done;
         enum vm_type type = page_get_type(p);
         struct page *child;
 
         if (p->operations->type == VM_UNINIT)
         {
             if (!vm_alloc_page_with_initializer(type, p->va, p->writable, p->uninit.init, p->uninit.aux))
-                return false;
+                goto done;
         }
         else
         {
             if (!vm_alloc_page(type, p->va, p->writable))
-                return false;
-            if (!vm_claim_page(p->va))
-                return false;
-
+                goto done;
             child = spt_find_page(dst, p->va);
-            memcpy(child->frame->kva, p->frame->kva, PGSIZE);
+
+            /* Resident anonymous pages are shared copy-on-write
+               instead of copied. */
+            if (type == VM_ANON && cow_share(src_pml4, p, child))
+                continue;
+
+            if (!vm_claim_page(p->va))
+                goto done;
+            if (p->frame != NULL)
+                memcpy(child->frame->kva, p->frame->kva, PGSIZE);
+            else if (type == VM_ANON)
+                anon_swap_read(p, child->frame->kva);
         }
     }
+    success = true;
 
-    return true;
+done:
+    lock_release(&src->claim_lock);
+    rwlock_release_read(&src->lock);
+    return success;
 }
 
 void hash_elem_destroy(struct hash_elem *e, void *aux UNUSED)
@@ -373,7 +967,10 @@ void supplemental_page_table_kill(struct supplemental_page_table *spt UNUSED)
      * TODO: writeback all the modified contents to the storage. */
     struct hash *hash = &spt->hash_table;
 
+    /* Keeps our frames from being evicted while we free them. */
+    lock_acquire(&spt->claim_lock);
     hash_clear(hash, hash_elem_destroy);
+    lock_release(&spt->claim_lock);
 }
 
 unsigned page_hash(const struct hash_elem *p_, void *aux UNUSED)